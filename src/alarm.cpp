@@ -0,0 +1,172 @@
+#include "alarm.h"
+
+static const clock_control_t *p_alarmClock = NULL;
+static alarm_t *p_alarmList = NULL;
+static uint8_t alarmInterrupts = 0;
+static bool alarmWakeup = false;
+
+void alarm_init(const clock_control_t *clockControl, const bool wakeEveryMinute)
+{
+    p_alarmClock = clockControl;
+    alarmInterrupts = 0;
+    alarmWakeup = wakeEveryMinute;
+
+    /* A2 wakes the MCU every minute so the display can follow while sleeping */
+    if (wakeEveryMinute)
+    {
+        DS3231_setAlarm2(DS3231_ALARM_EVERY, 0, 0, 0);
+        alarmInterrupts |= DS3231_A2IE;
+    }
+    else
+    {
+        /* Flags are polled, INT/SQW keeps the square wave */
+        DS3231_setAlarmInterrupts(0);
+    }
+
+    alarm_reload();
+}
+
+void alarm_add(alarm_t *alarm)
+{
+    alarm->next = p_alarmList;
+    p_alarmList = alarm;
+    alarm_reload();
+}
+
+void alarm_remove(alarm_t *alarm)
+{
+    for (alarm_t **pp_alarm = &p_alarmList; *pp_alarm != NULL; pp_alarm = &(*pp_alarm)->next)
+    {
+        if (*pp_alarm == alarm)
+        {
+            *pp_alarm = alarm->next;
+            alarm->next = NULL;
+            break;
+        }
+    }
+    alarm_reload();
+}
+
+uint32_t alarm_secondsUntil(const alarm_t *alarm)
+{
+    clock_control_t snapshot;
+    const clock_control_t *now = &snapshot;
+    clock_snapshot(p_alarmClock, &snapshot);
+    int32_t nowOfDay = (now->time.hours * 3600L) + (now->time.minutes * 60) + now->time.seconds;
+    int32_t atOfDay = (alarm->time.hours * 3600L) + (alarm->time.minutes * 60) + alarm->time.seconds;
+    int32_t delta;
+    int32_t period;
+
+    switch (alarm->mode)
+    {
+    case DS3231_ALARM_EVERY:
+        return 1;
+
+    case DS3231_ALARM_SECONDS:
+        delta = alarm->time.seconds - now->time.seconds;
+        period = SECONDS_PER_MINUTE;
+        break;
+
+    case DS3231_ALARM_MINUTES:
+        delta = ((alarm->time.minutes * 60) + alarm->time.seconds) - ((now->time.minutes * 60) + now->time.seconds);
+        period = 3600L;
+        break;
+
+    case DS3231_ALARM_HOURS:
+        delta = atOfDay - nowOfDay;
+        period = SECONDS_PER_DAY;
+        break;
+
+    case DS3231_ALARM_DAY:
+        delta = ((alarm->day - now->weekday) * (int32_t)SECONDS_PER_DAY) + atOfDay - nowOfDay;
+        period = DAYS_PER_WEEK * SECONDS_PER_DAY;
+        break;
+
+    case DS3231_ALARM_DATE:
+        delta = ((alarm->day - now->date.days) * (int32_t)SECONDS_PER_DAY) + atOfDay - nowOfDay;
+        period = now->daysInCurrentMonth * SECONDS_PER_DAY;
+        break;
+
+    default:
+        return UINT32_MAX;
+    }
+
+    /* Strictly in the future, a match on the current second is already due */
+    if (delta <= 0)
+    {
+        delta += period;
+    }
+
+    return delta;
+}
+
+void alarm_reload(void)
+{
+    alarm_t *p_nearest = NULL;
+    uint32_t nearest = UINT32_MAX;
+
+    if (p_alarmClock == NULL)
+    {
+        return;
+    }
+
+    for (alarm_t *p_alarm = p_alarmList; p_alarm != NULL; p_alarm = p_alarm->next)
+    {
+        p_alarm->armed = false;
+        if (!p_alarm->enabled)
+        {
+            continue;
+        }
+
+        uint32_t until = alarm_secondsUntil(p_alarm);
+        if (until < nearest)
+        {
+            nearest = until;
+            p_nearest = p_alarm;
+        }
+    }
+
+    /* Every alarm sharing the nearest instant fires from the same A1 match */
+    for (alarm_t *p_alarm = p_alarmList; p_alarm != NULL; p_alarm = p_alarm->next)
+    {
+        if (p_alarm->enabled && (alarm_secondsUntil(p_alarm) == nearest))
+        {
+            p_alarm->armed = true;
+        }
+    }
+
+    if (p_nearest != NULL)
+    {
+        DS3231_setAlarm1(p_nearest->mode, (p_nearest->mode == DS3231_ALARM_DAY) ? p_nearest->day + 1 : p_nearest->day,
+                         p_nearest->time.hours, p_nearest->time.minutes, p_nearest->time.seconds);
+    }
+
+    if (alarmWakeup)
+    {
+        DS3231_setAlarmInterrupts(alarmInterrupts | ((p_nearest != NULL) ? DS3231_A1IE : 0));
+    }
+}
+
+uint8_t alarm_service(void)
+{
+    if ((p_alarmList == NULL) && (alarmInterrupts == 0))
+    {
+        return 0;
+    }
+
+    uint8_t fired = DS3231_checkAlarms();
+
+    if (fired & DS3231_A1F)
+    {
+        for (alarm_t *p_alarm = p_alarmList; p_alarm != NULL; p_alarm = p_alarm->next)
+        {
+            if (p_alarm->armed && (p_alarm->handler != NULL))
+            {
+                p_alarm->handler(p_alarm);
+            }
+        }
+        alarm_reload();
+    }
+
+    return fired;
+}
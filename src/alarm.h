@@ -0,0 +1,28 @@
+#ifndef ALARM_H_
+#define ALARM_H_
+
+#include "clock.h"
+
+typedef struct alarm alarm_t;
+typedef void (*alarm_handler_t)(alarm_t *alarm);
+
+struct alarm
+{
+  DS3231_alarm_mode_t mode;
+  uint8_t day; /* Date (1-31) for DS3231_ALARM_DATE, weekday for DS3231_ALARM_DAY */
+  time_hms_t time;
+  bool enabled;
+  bool armed;
+  alarm_handler_t handler;
+  alarm_t *next;
+};
+
+void alarm_init( const clock_control_t *clockControl, const bool wakeEveryMinute );
+void alarm_add( alarm_t *alarm );
+void alarm_remove( alarm_t *alarm );
+void alarm_reload( void );
+
+uint8_t alarm_service( void );
+uint32_t alarm_secondsUntil( const alarm_t *alarm );
+
+#endif /* ALARM_H_ */
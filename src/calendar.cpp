@@ -0,0 +1,108 @@
+#include <avr/pgmspace.h>
+
+#include "calendar.h"
+
+static constexpr uint8_t monthDays(const uint8_t month, const bool leap)
+{
+    return (month == 2) ? (28 + leap) : (30 + ((month + (month >> 3)) & 1));
+}
+
+/* Days before the first of month m (1-based), m = 13 gives the year length */
+static constexpr uint16_t daysBefore(const uint8_t month, const bool leap)
+{
+    return (month <= 1) ? 0 : daysBefore(month - 1, leap) + monthDays(month - 1, leap);
+}
+
+#define DAYS_BEFORE_ROW(leap) \
+    {daysBefore(1, leap), daysBefore(2, leap), daysBefore(3, leap), daysBefore(4, leap), \
+     daysBefore(5, leap), daysBefore(6, leap), daysBefore(7, leap), daysBefore(8, leap), \
+     daysBefore(9, leap), daysBefore(10, leap), daysBefore(11, leap), daysBefore(12, leap), \
+     daysBefore(13, leap)}
+
+static const uint16_t cumulativeDays[2][13] PROGMEM = {DAYS_BEFORE_ROW(false), DAYS_BEFORE_ROW(true)};
+
+static_assert(daysBefore(13, false) == DAYS_PER_YEAR, "common year must have 365 days");
+static_assert(daysBefore(13, true) == DAYS_PER_YEAR + 1, "leap year must have 366 days");
+
+bool isLeapYear(const uint16_t year)
+{
+    /* A multiple of 100 is a multiple of 25, so it is a multiple of 400 if it is one of 16 */
+    return !(year & ((year % 25) ? 3 : 15));
+}
+
+uint8_t calendar_monthLength(const uint8_t month, const bool leap)
+{
+    const uint16_t *row = cumulativeDays[leap];
+    return pgm_read_word(&row[month]) - pgm_read_word(&row[month - 1]);
+}
+
+uint8_t month_length(const uint16_t year, const uint8_t month)
+{
+    return calendar_monthLength(month, isLeapYear(year));
+}
+
+uint16_t calendar_dayOfYear(const uint16_t year, const uint8_t month, const uint8_t day)
+{
+    return pgm_read_word(&cumulativeDays[isLeapYear(year)][month - 1]) + day;
+}
+
+/* Days from 1 Jan CALENDAR_BASE_YEAR, a leap year divisible by 400, to 1 Jan of year */
+uint16_t calendar_daysBeforeYear(const uint16_t year)
+{
+    uint16_t y = year - CALENDAR_BASE_YEAR;
+    return (y * DAYS_PER_YEAR) + ((y + 3) / 4) - ((y + 99) / 100) + ((y + 399) / 400);
+}
+
+void calendar_monthDay(const uint16_t dayOfYear, const bool leap, uint8_t *month, uint8_t *day)
+{
+    const uint16_t *row = cumulativeDays[leap];
+
+    /* No month is longer than 32 days, so this is at most two months early */
+    uint8_t m = (dayOfYear - 1) >> 5;
+    while (pgm_read_word(&row[m + 1]) < dayOfYear)
+    {
+        m++;
+    }
+    *month = m + 1;
+    *day = dayOfYear - pgm_read_word(&row[m]);
+}
+
+uint8_t calendar_jan1Weekday(const uint16_t year)
+{
+    /* Gauss, 0 = Sunday */
+    uint16_t y = year - 1;
+    return (1 + (5 * (y & 3)) + (4 * (y % 100)) + (6 * (y % 400))) % DAYS_PER_WEEK;
+}
+
+uint8_t calendar_weekday(const uint16_t year, const uint8_t month, const uint8_t day)
+{
+    return (calendar_jan1Weekday(year) + calendar_dayOfYear(year, month, day) - 1) % DAYS_PER_WEEK;
+}
+
+uint8_t calendar_weeksInYear(const uint16_t year)
+{
+    /* 53 weeks when the year starts on a Thursday, or on a Wednesday in a leap year */
+    uint8_t jan1 = calendar_jan1Weekday(year);
+    return 52 + ((jan1 == ISO_THURSDAY) || ((jan1 == ISO_THURSDAY - 1) && isLeapYear(year)));
+}
+
+uint8_t calendar_isoWeek(const uint16_t year, const uint8_t month, const uint8_t day)
+{
+    uint16_t dayOfYear = calendar_dayOfYear(year, month, day);
+    uint8_t isoWeekday = (calendar_jan1Weekday(year) + dayOfYear - 1) % DAYS_PER_WEEK;
+    if (isoWeekday == 0)
+    {
+        isoWeekday = DAYS_PER_WEEK;
+    }
+
+    int16_t week = (int16_t)(dayOfYear - isoWeekday + 10) / DAYS_PER_WEEK;
+    if (week < 1)
+    {
+        return calendar_weeksInYear(year - 1);
+    }
+    if (week > calendar_weeksInYear(year))
+    {
+        return 1;
+    }
+    return week;
+}
@@ -0,0 +1,28 @@
+#ifndef CALENDAR_H_
+#define CALENDAR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DAYS_PER_WEEK 7
+#define DAYS_PER_YEAR 365
+#define ISO_THURSDAY 4
+
+/* First year of the epoch and of calendar_daysBeforeYear */
+#define CALENDAR_BASE_YEAR 2000
+
+bool isLeapYear( const uint16_t year );
+
+uint8_t month_length( const uint16_t year, const uint8_t month );
+uint8_t calendar_monthLength( const uint8_t month, const bool leap );
+uint8_t calendar_jan1Weekday( const uint16_t year );
+uint8_t calendar_weekday( const uint16_t year, const uint8_t month, const uint8_t day );
+uint8_t calendar_weeksInYear( const uint16_t year );
+uint8_t calendar_isoWeek( const uint16_t year, const uint8_t month, const uint8_t day );
+
+uint16_t calendar_dayOfYear( const uint16_t year, const uint8_t month, const uint8_t day );
+uint16_t calendar_daysBeforeYear( const uint16_t year );
+
+void calendar_monthDay( const uint16_t dayOfYear, const bool leap, uint8_t *month, uint8_t *day );
+
+#endif /* CALENDAR_H_ */
@@ -0,0 +1,151 @@
+#include <util/atomic.h>
+
+#include "calibration.h"
+#include "timebase.h"
+
+static calibration_t calibration;
+
+/* Latest reference edge and the RTC timebase captured with it */
+static volatile uint32_t sampleReference = 0;
+static volatile uint32_t sampleTicks = 0;
+static volatile bool sampleValid = false;
+
+static uint32_t windowReference = 0;
+static uint32_t windowTicks = 0;
+static bool windowOpen = false;
+
+void calibration_start()
+{
+    calibration.active = true;
+    calibration.converged = false;
+    calibration.records = 0;
+    calibration.aging = (int8_t)DS3231_getByte(DS3231_AGING);
+    windowOpen = false;
+    sampleValid = false;
+    sampleReference = 0;
+
+    /* Reference pulse (e.g. GPS 1PPS) on INT1 (PD3), rising edge */
+    DDRD &= ~_BV(PORTD3);
+    EICRA |= (_BV(ISC11) | _BV(ISC10));
+    EIMSK |= _BV(INT1);
+}
+
+void calibration_stop()
+{
+    EIMSK &= ~_BV(INT1);
+    calibration.active = false;
+}
+
+void calibration_pulse()
+{
+    sampleReference++;
+    sampleTicks = timebase_ticks();
+    sampleValid = true;
+}
+
+void calibration_timestamp(const uint32_t referenceSeconds)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        sampleReference = referenceSeconds;
+        sampleTicks = timebase_ticks();
+        sampleValid = true;
+    }
+}
+
+bool calibration_service()
+{
+    uint32_t reference;
+    uint32_t ticks;
+    bool valid;
+
+    if (!calibration.active)
+    {
+        return false;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        reference = sampleReference;
+        ticks = sampleTicks;
+        valid = sampleValid;
+    }
+
+    if (!valid)
+    {
+        return false;
+    }
+
+    if (!windowOpen)
+    {
+        windowReference = reference;
+        windowTicks = ticks;
+        windowOpen = true;
+        return false;
+    }
+
+    uint32_t referenceElapsed = reference - windowReference;
+    if (referenceElapsed < CALIBRATION_WINDOW)
+    {
+        return false;
+    }
+
+    /* RTC ticks counted against the ticks the reference says should have passed */
+    uint32_t expected = referenceElapsed * timebase_rate();
+    int32_t difference = (int32_t)((ticks - windowTicks) - expected);
+    int32_t error = (int32_t)(((int64_t)difference * 100000000LL) / (int64_t)expected);
+
+    calibration_record_t *p_record = &calibration.history[calibration.records % CALIBRATION_HISTORY];
+    calibration.records++;
+    p_record->referenceSeconds = referenceElapsed;
+    p_record->error = error;
+
+    if ((error > -CALIBRATION_TOLERANCE) && (error < CALIBRATION_TOLERANCE))
+    {
+        calibration.converged = true;
+        calibration_stop();
+    }
+    else
+    {
+        /* Positive aging slows the oscillator, one LSB is about 0.1 ppm */
+        int16_t aging = calibration.aging + ((error + ((error < 0) ? -5 : 5)) / 10);
+        if (aging > INT8_MAX)
+        {
+            aging = INT8_MAX;
+        }
+        else if (aging < INT8_MIN)
+        {
+            aging = INT8_MIN;
+        }
+        calibration.aging = (int8_t)aging;
+
+        DS3231_setByte(DS3231_AGING, (uint8_t)calibration.aging);
+        DS3231_forceConversion();
+    }
+    p_record->aging = calibration.aging;
+
+    /* Next window starts from this edge */
+    windowReference = reference;
+    windowTicks = ticks;
+
+    return true;
+}
+
+const calibration_t *calibration_status()
+{
+    return &calibration;
+}
+
+const calibration_record_t *calibration_last()
+{
+    if (calibration.records == 0)
+    {
+        return NULL;
+    }
+    return &calibration.history[(calibration.records - 1) % CALIBRATION_HISTORY];
+}
+
+ISR(INT1_vect)
+{
+    calibration_pulse();
+}
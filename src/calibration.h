@@ -0,0 +1,37 @@
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+#include "clock.h"
+
+/* Reference seconds per measurement window */
+#define CALIBRATION_WINDOW 3600UL
+#define CALIBRATION_HISTORY 8
+/* Error considered converged, centi-ppm (one aging LSB is about 10) */
+#define CALIBRATION_TOLERANCE 10
+
+typedef struct
+{
+  uint32_t referenceSeconds; /* Length of the window */
+  int32_t error;             /* Centi-ppm, positive when the RTC runs fast */
+  int8_t aging;              /* Aging offset written after the window */
+} calibration_record_t;
+
+typedef struct
+{
+  bool active;
+  bool converged;
+  int8_t aging;
+  uint8_t records; /* Windows completed, history wraps around */
+  calibration_record_t history[CALIBRATION_HISTORY];
+} calibration_t;
+
+void calibration_start( void );
+void calibration_stop( void );
+void calibration_pulse( void );
+void calibration_timestamp( const uint32_t referenceSeconds );
+
+bool calibration_service( void );
+const calibration_t *calibration_status( void );
+const calibration_record_t *calibration_last( void );
+
+#endif /* CALIBRATION_H_ */
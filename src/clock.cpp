@@ -1,12 +1,123 @@
 #include "clock.h"
+#include "layout.h"
+#include "display.h"
+#include "alarm.h"
+
+static constexpr char weekdayLayout[] = "%a";
+static constexpr char weekLayout[] = "W%V";
+static constexpr char dateLayout[] = CLOCK_DATE_LAYOUT;
+/* The driver drops the UTF-8 degree sign, the panel only ever showed the C */
+static constexpr char temperatureLayout[] = "%qC";
+
+/* Retained OLED content, only cells that changed since the last second are sent */
+static display_field_t weekdayField = DISPLAY_FIELD(0, 0, layout<weekdayLayout>::length);
+static display_field_t weekField = DISPLAY_FIELD(18, 0, layout<weekLayout>::length);
+static display_field_t dateField = DISPLAY_FIELD(0, 3, layout<dateLayout>::length);
+static display_field_t temperatureField = DISPLAY_FIELD(0, 6, layout<temperatureLayout>::length);
+
+static_assert(layout<dateLayout>::length <= DISPLAY_FIELD_MAX, "CLOCK_DATE_LAYOUT is wider than a display field");
+static_assert(layout<temperatureLayout>::length <= DISPLAY_FIELD_MAX, "temperatureLayout is wider than a display field");
+
+/* Compiler barrier, keeps the struct accesses between the sequence updates */
+#define CLOCK_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/* Odd while the tick ISR is rewriting the clock, bumped twice per tick */
+static volatile uint8_t clockSequence = 0;
+
+/* Interrupt context only, publishes one tick to clock_snapshot readers */
+void clock_tick(clock_control_t *clockControl)
+{
+    clockSequence++;
+    CLOCK_BARRIER();
+    tickSeconds(clockControl);
+    CLOCK_BARRIER();
+    clockSequence++;
+}
+
+/*
+ * Consistent copy of the clock without masking interrupts, retried when a
+ * tick landed during the copy. Writers in the main loop must hold off the
+ * tick with an ATOMIC_BLOCK instead.
+ */
+void clock_snapshot(const clock_control_t *clockControl, clock_control_t *snapshot)
+{
+    uint8_t sequence;
+
+    do
+    {
+        sequence = clockSequence;
+        CLOCK_BARRIER();
+        memcpy(snapshot, clockControl, sizeof(clock_control_t));
+        CLOCK_BARRIER();
+    } while ((sequence & 1) || (sequence != clockSequence));
+}
+
+#ifdef CLOCK_BCD_CORE
+/* Packed BCD increment, returns true and wraps to 0 when limit is reached */
+static bool bcdIncrement(uint8_t *value, const uint8_t limit)
+{
+    uint8_t next = *value + 1;
+
+    /* Decimal adjust, 0x?A carries into the tens nibble */
+    if ((next & 0x0F) == 0x0A)
+    {
+        next += 0x06;
+    }
+    if (next == limit)
+    {
+        next = 0;
+    }
+    *value = next;
+    return (next == 0);
+}
+#endif /* CLOCK_BCD_CORE */
+
+/* Two ASCII digits one up, returns true and wraps to "00" when limit is reached */
+static inline bool asciiIncrement(char *digits, const uint8_t limit)
+{
+    if (++digits[1] > '9')
+    {
+        digits[1] = '0';
+        digits[0]++;
+    }
+    if ((digits[0] == '0' + (limit / 10)) && (digits[1] == '0' + (limit % 10)))
+    {
+        digits[0] = '0';
+        digits[1] = '0';
+        return true;
+    }
+    return false;
+}
+
+static void writeDateString(clock_control_t *clockControl)
+{
+    char *dateString = clockControl->dateString;
+
+    format_uint(&dateString[0], clockControl->date.years.yyyy, 4);
+    dateString[4] = '-';
+    format_uint(&dateString[5], clockControl->date.months, 2);
+    dateString[7] = '-';
+    format_uint(&dateString[8], clockControl->date.days, 2);
+    dateString[10] = '\0';
+}
 
 uint8_t tickSeconds(clock_control_t *clockControl)
 {
-    clockControl->time.seconds++;
+#ifdef CLOCK_BCD_CORE
+    time_hms_t *bcdTime = &clockControl->bcdTime;
+
+    if (bcdIncrement(&bcdTime->seconds, 0x60) && bcdIncrement(&bcdTime->minutes, 0x60))
+    {
+        bcdIncrement(&bcdTime->hours, 0x24);
+    }
+#endif /* CLOCK_BCD_CORE */
+    clock_add(clockControl, SECONDS, 1, true);
 
-    if (clockControl->time.seconds >= SECONDS_PER_MINUTE)
+    /* Only the digits that changed, the date string once a day */
+    char *timeString = clockControl->timeString;
+    if (asciiIncrement(&timeString[6], SECONDS_PER_MINUTE) && asciiIncrement(&timeString[3], MINUTES_PER_HOUR) && asciiIncrement(&timeString[0], HOURS_PER_DAY))
     {
-        clockControl->time.seconds = 0;
+        writeDateString(clockControl);
     }
 
     return clockControl->time.seconds;
@@ -31,20 +142,13 @@ uint8_t bcdToDec(uint8_t value)
 
 uint8_t getWeekday(const date_ymd_t *date)
 {
-    uint16_t y = date->years.yyyy;
-    uint8_t m = date->months;
-    uint8_t d = date->days;
-
-    return (d += m < 3 ? y-- : y - 2, 23 * m / 9 + d + 4 + y / 4 - y / 100 + y / 400) % 7;
+    return calendar_weekday(date->years.yyyy, date->months, date->days);
 }
 
 void printTime(clock_control_t *clockControl)
 {
-    char buffer[40];
-    // sprintf(buffer, "%04d-%02d-%02d\t%02d:%02d:%02d\n", clockControl->date.years.yyyy, clockControl->date.months, clockControl->date.days, clockControl->time.hours, clockControl->time.minutes, clockControl->time.seconds);
-    // uart_puts(buffer);
-    sprintf(buffer, "%02d:%02d:%02d\n", clockControl->time.hours, clockControl->time.minutes, clockControl->time.seconds);
-    uart_puts(buffer);
+    uart_puts(clockControl->timeString);
+    uart_putc('\n');
 }
 
 void timeToBCD(const time_hms_t timeBuffer, uint8_t *bcdBuffer)
@@ -57,98 +161,101 @@ void timeToBCD(const time_hms_t timeBuffer, uint8_t *bcdBuffer)
     bcdBuffer[5] = timeBuffer.seconds - (bcdBuffer[4] * 10);
 }
 
+/* Unpacks the nibbles of a packed BCD time, no division needed */
+void packedToBCD(const time_hms_t bcdTime, uint8_t *bcdBuffer)
+{
+    bcdBuffer[0] = bcdTime.hours >> 4;
+    bcdBuffer[1] = bcdTime.hours & 0x0F;
+    bcdBuffer[2] = bcdTime.minutes >> 4;
+    bcdBuffer[3] = bcdTime.minutes & 0x0F;
+    bcdBuffer[4] = bcdTime.seconds >> 4;
+    bcdBuffer[5] = bcdTime.seconds & 0x0F;
+}
+
 void clockToLED(uint8_t *buffer)
 {
-    i2c_start_sla(TW_SLA_W(LED_DRIVER_ADDRESS));
+    static i2c_transaction_t ledTransaction = {LED_DRIVER_ADDRESS, NULL, 7, NULL, 0, NULL, NULL, I2C_IDLE, 0, 0};
 
-    for (size_t i = 0; i < 7; i++)
+    /* Previous frame is still on the bus */
+    if ((ledTransaction.status == I2C_QUEUED) || (ledTransaction.status == I2C_ACTIVE))
     {
-        i2c_write(buffer[i]);
+        return;
     }
 
-    i2c_stop();
+    ledTransaction.writeBuffer = buffer;
+    i2c_enqueue(&ledTransaction);
 }
 
 void clockToOLED( clock_control_t *clockControl )
 {
-    char buffer[12];
-    
-    oled_home();
+    char buffer[DISPLAY_FIELD_MAX + 1];
 
-    weekdayToString(clockControl->weekday, buffer);
-    oled_puts(buffer);
+    layout<weekdayLayout>::render(buffer, clockControl);
+    display_update(&weekdayField, buffer);
 
-    oled_gotoxy(0, 3);
-    sprintf(buffer, "%02d-%02d-%04d", clockControl->date.days, clockControl->date.months, clockControl->date.years.yyyy);
-    oled_puts(buffer);
+    layout<weekLayout>::render(buffer, clockControl);
+    display_update(&weekField, buffer);
 
-    oled_gotoxy(0, 6);
-    sprintf(buffer, "%.2f°C", clockControl->temperature);
-    oled_puts(buffer);
+    layout<dateLayout>::render(buffer, clockControl);
+    display_update(&dateField, buffer);
+
+    layout<temperatureLayout>::render(buffer, clockControl);
+    display_update(&temperatureField, buffer);
 }
 
+static const char weekdayNames[DAYS_PER_WEEK][10] PROGMEM = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
+
 void weekdayToString(uint8_t weekday, char *string)
 {
-    switch (weekday)
+    if (weekday < DAYS_PER_WEEK)
     {
-    case SUNDAY:
-        sprintf(string, "Sunday");
-        break;
-
-    case MONDAY:
-        sprintf(string, "Monday");
-        break;
-
-    case TUESDAY:
-        sprintf(string, "Tuesday");
-        break;
-
-    case WEDNESDAY:
-        sprintf(string, "Wednesday");
-        break;
-
-    case THURSDAY:
-        sprintf(string, "Thursday");
-        break;
-
-    case FRIDAY:
-        sprintf(string, "Friday");
-        break;
-
-    case SATURDAY:
-        sprintf(string, "Saturday");
-        break;
-
-    default:
-        break;
+        strcpy_P(string, weekdayNames[weekday]);
     }
 }
 
-void syncControl(uint8_t address, DS3231_buffer_t *buffer, clock_control_t *control)
+void temperatureToString(const int16_t temperature, char *string, const uint8_t decimals)
+{
+    /* Q8.2, the fraction is a multiple of .25 and one decimal rounds half to even like printf */
+    *format_fixed(string, temperature, 2, decimals) = '\0';
+}
+
+void syncControl(uint8_t address, const DS3231_buffer_t *buffer, clock_control_t *control)
 {
     switch (address)
     {
     case DS3231_SECONDS:
         control->time.seconds = ((buffer->seconds.nibbles.ms_nibble * 5) << 1) + buffer->seconds.nibbles.ls_nibble;
+#ifdef CLOCK_BCD_CORE
+        control->bcdTime.seconds = buffer->seconds.byte;
+#endif /* CLOCK_BCD_CORE */
         break;
 
     case DS3231_MINUTES:
         control->time.minutes = ((buffer->minutes.nibbles.ms_nibble * 5) << 1) + buffer->minutes.nibbles.ls_nibble;
+#ifdef CLOCK_BCD_CORE
+        control->bcdTime.minutes = buffer->minutes.byte;
+#endif /* CLOCK_BCD_CORE */
         break;
 
     case DS3231_HOURS:
         if (buffer->hours.bits.b6)
         {
             control->time.hours = ((buffer->hours.bits.b4 * 5) << 1) + buffer->hours.nibbles.ls_nibble;
+#ifdef CLOCK_BCD_CORE
+            control->bcdTime.hours = DS3231_toBcd(control->time.hours);
+#endif /* CLOCK_BCD_CORE */
         }
         else
         {
             control->time.hours = ((buffer->hours.nibbles.ms_nibble * 5) << 1) + buffer->hours.nibbles.ls_nibble;
+#ifdef CLOCK_BCD_CORE
+            control->bcdTime.hours = buffer->hours.byte & 0x3F;
+#endif /* CLOCK_BCD_CORE */
         }
         break;
 
     case DS3231_DAYS:
-        control->weekday = buffer->days.byte;
+        control->weekday = buffer->days.byte - 1;
         break;
 
     case DS3231_DATE:
@@ -157,10 +264,12 @@ void syncControl(uint8_t address, DS3231_buffer_t *buffer, clock_control_t *cont
 
     case DS3231_MONTH:
         control->date.months = ((buffer->month_century.bits.b4 * 5) << 1) + buffer->month_century.nibbles.ls_nibble;
+        control->daysInCurrentMonth = month_length(control->date.years.yyyy, control->date.months);
         break;
 
     case DS3231_YEAR:
         control->date.years.yyyy = 2000U + ((buffer->years.nibbles.ms_nibble * 5) << 1) + buffer->years.nibbles.ls_nibble;
+        control->daysInCurrentMonth = month_length(control->date.years.yyyy, control->date.months);
         break;
 
     default:
@@ -168,189 +277,235 @@ void syncControl(uint8_t address, DS3231_buffer_t *buffer, clock_control_t *cont
     }
 }
 
-void update_clock(clock_control_t *clockControl, const clock_units_t unit, const sign_t sign, const bool affectNextUnit, const bool printTime)
+void syncRTC(const clock_control_t *control, DS3231_buffer_t *buffer)
 {
-    switch (unit)
-    {
-    case SECONDS:
-        switch (sign)
-        {
-        case MINUS:
-            clockControl->time.seconds--;
-            if (clockControl->time.seconds >= SECONDS_PER_MINUTE)
-            {
-                clockControl->time.seconds = SECONDS_PER_MINUTE - 1;
-            }
-            break;
+    uint8_t year = control->date.years.yyyy % 100;
+
+#ifdef CLOCK_BCD_CORE
+    buffer->seconds.byte = control->bcdTime.seconds;
+    buffer->minutes.byte = control->bcdTime.minutes;
+    buffer->hours.byte = control->bcdTime.hours;
+#else
+    buffer->seconds.byte = DS3231_toBcd(control->time.seconds);
+    buffer->minutes.byte = DS3231_toBcd(control->time.minutes);
+    buffer->hours.byte = DS3231_toBcd(control->time.hours);
+#endif /* CLOCK_BCD_CORE */
+    buffer->days.byte = control->weekday + 1;
+    buffer->date.byte = DS3231_toBcd(control->date.days);
+    buffer->month_century.byte = DS3231_toBcd(control->date.months);
+    buffer->month_century.bits.b7 = (control->date.years.yyyy >= 2100U);
+    buffer->years.byte = DS3231_toBcd(year);
+
+    DS3231_setDateTime(buffer);
+}
 
-        case PLUS:
-            clockControl->time.seconds++;
-            if (clockControl->time.seconds >= SECONDS_PER_MINUTE)
-            {
-                clockControl->time.seconds = 0;
-                if (affectNextUnit)
-                {
-                    update_clock(clockControl, MINUTES, PLUS, true, false);
-                }
-            }
-            break;
+/* Radix of the fixed units in carry order, indexed by clock_units_t */
+static constexpr uint8_t timeRadix[] = {SECONDS_PER_MINUTE, MINUTES_PER_HOUR, HOURS_PER_DAY};
+static_assert(sizeof(timeRadix) == DAYS, "timeRadix must cover every unit below DAYS");
 
-        default:
-            break;
-        }
-        break;
+/* One day forward or back, only a year change needs a division */
+static void stepDay(clock_control_t *clockControl, const int8_t direction)
+{
+    date_ymd_t *date = &clockControl->date;
 
-    case MINUTES:
-        switch (sign)
+    if (direction > 0)
+    {
+        clockControl->weekday = (clockControl->weekday == DAYS_PER_WEEK - 1) ? 0 : clockControl->weekday + 1;
+        clockControl->dayOfYear++;
+        if (++date->days > clockControl->daysInCurrentMonth)
         {
-        case MINUS:
-            clockControl->time.minutes--;
-            if (clockControl->time.minutes >= MINUTES_PER_HOUR)
+            date->days = 1;
+            if (++date->months > MONTHS_PER_YEAR)
             {
-                clockControl->time.minutes = MINUTES_PER_HOUR - 1;
+                date->months = 1;
+                date->years.yyyy++;
+                clockControl->dayOfYear = 1;
+                clockControl->leapYear = isLeapYear(date->years.yyyy);
+                date->years.__yy = date->years.yyyy % 100;
+                date->years.yy__ = date->years.yyyy - date->years.__yy;
             }
-            break;
-
-        case PLUS:
-            clockControl->time.minutes++;
-            if (clockControl->time.minutes >= MINUTES_PER_HOUR)
-            {
-                clockControl->time.minutes = 0;
-                if (affectNextUnit)
-                {
-                    update_clock(clockControl, HOURS, PLUS, true, false);
-                }
-            }
-            break;
-
-        default:
-            break;
+            clockControl->daysInCurrentMonth = calendar_monthLength(date->months, clockControl->leapYear);
         }
-        break;
-
-    case HOURS:
-        switch (sign)
+    }
+    else
+    {
+        clockControl->weekday = (clockControl->weekday == 0) ? DAYS_PER_WEEK - 1 : clockControl->weekday - 1;
+        clockControl->dayOfYear--;
+        if (--date->days == 0)
         {
-        case MINUS:
-            clockControl->time.hours--;
-            if (clockControl->time.hours >= HOURS_PER_DAY)
+            if (--date->months == 0)
             {
-                clockControl->time.hours = HOURS_PER_DAY - 1;
+                date->months = MONTHS_PER_YEAR;
+                date->years.yyyy--;
+                clockControl->leapYear = isLeapYear(date->years.yyyy);
+                clockControl->dayOfYear = DAYS_PER_YEAR + clockControl->leapYear;
+                date->years.__yy = date->years.yyyy % 100;
+                date->years.yy__ = date->years.yyyy - date->years.__yy;
             }
-            break;
+            clockControl->daysInCurrentMonth = calendar_monthLength(date->months, clockControl->leapYear);
+            date->days = clockControl->daysInCurrentMonth;
+        }
+    }
+}
 
-        case PLUS:
-            clockControl->time.hours++;
-            if (clockControl->time.hours >= HOURS_PER_DAY)
-            {
-                clockControl->time.hours = 0;
-                if (affectNextUnit)
-                {
-                    update_clock(clockControl, DAYS, PLUS, true, false);
-                }
-            }
-            break;
+void clock_add(clock_control_t *clockControl, const clock_units_t unit, int16_t amount, const bool carry)
+{
+    uint8_t *timeField[] = {&clockControl->time.seconds, &clockControl->time.minutes, &clockControl->time.hours};
+    date_ymd_t *date = &clockControl->date;
+    uint8_t u = unit;
+    bool dateChanged = false;
 
-        default:
-            break;
+    /* Seconds, minutes and hours, the quotient is the carry into the next unit */
+    for (; (u < DAYS) && (amount != 0); u++)
+    {
+        int16_t value = *timeField[u] + amount;
+        amount = value / timeRadix[u];
+        value -= amount * timeRadix[u];
+        if (value < 0)
+        {
+            value += timeRadix[u];
+            amount--;
         }
-        break;
+        *timeField[u] = value;
 
-    case DAYS:
-        switch (sign)
+        if (!carry)
         {
-        case MINUS:
-            clockControl->date.days--;
-            if ((clockControl->date.days == 0) || (clockControl->date.days >= clockControl->daysInCurrentMonth))
-            {
-                clockControl->date.days = month_length(clockControl->date.years.yyyy, clockControl->date.months);
-            }
-            break;
+            return;
+        }
+    }
 
-        case PLUS:
-            clockControl->date.days++;
-            if (clockControl->date.days >= clockControl->daysInCurrentMonth)
-            {
-                clockControl->date.days = 1;
-                if (affectNextUnit)
-                {
-                    update_clock(clockControl, MONTHS, PLUS, true, false);
-                }
-            }
-            break;
+    if (amount == 0)
+    {
+        return;
+    }
 
-        case NO_SIGN:
-            if (clockControl->date.days >= clockControl->daysInCurrentMonth)
-            {
-                clockControl->date.days = month_length(clockControl->date.years.yyyy, clockControl->date.months);
-            }
-            break;
+    if (((u == DAYS) || (u == DATE)) && carry && ((amount == 1) || (amount == -1)))
+    {
+        /* Day rollover, derived fields follow by increments */
+        stepDay(clockControl, amount);
+        return;
+    }
 
-        default:
-            break;
-        }
-        clockControl->weekday = getWeekday(&clockControl->date);
-        break;
+    if ((u == DAYS) || (u == DATE))
+    {
+        int16_t day = date->days + amount;
+        amount = 0;
 
-    case MONTHS:
-        switch (sign)
+        if (carry)
         {
-        case MINUS:
-            clockControl->date.months--;
-            if ((clockControl->date.months == 0) || (clockControl->date.months >= MONTHS_PER_YEAR))
+            /* Walk whole months, one step per month crossed */
+            while (day > clockControl->daysInCurrentMonth)
             {
-                clockControl->date.months = MONTHS_PER_YEAR;
+                day -= clockControl->daysInCurrentMonth;
+                if (++date->months > MONTHS_PER_YEAR)
+                {
+                    date->months = 1;
+                    date->years.yyyy++;
+                }
+                clockControl->daysInCurrentMonth = month_length(date->years.yyyy, date->months);
             }
-            clockControl->daysInCurrentMonth = month_length(clockControl->date.months, clockControl->date.years.yyyy);
-            update_clock(clockControl, DAYS, NO_SIGN, false, false);
-            break;
-
-        case PLUS:
-            clockControl->date.months++;
-            if (clockControl->date.months >= MONTHS_PER_YEAR)
+            while (day < 1)
             {
-                clockControl->date.months = 1;
-                if (affectNextUnit)
+                if (--date->months == 0)
                 {
-                    update_clock(clockControl, YEARS, PLUS, true, false);
+                    date->months = MONTHS_PER_YEAR;
+                    date->years.yyyy--;
                 }
+                clockControl->daysInCurrentMonth = month_length(date->years.yyyy, date->months);
+                day += clockControl->daysInCurrentMonth;
             }
-            clockControl->daysInCurrentMonth = month_length(clockControl->date.months, clockControl->date.years.yyyy);
-            update_clock(clockControl, DAYS, NO_SIGN, false, false);
-            break;
-
-        default:
-            break;
         }
-        break;
-
-    case YEARS:
-        switch (sign)
+        else
         {
-        case MINUS:
-            clockControl->date.years.yyyy--;
-            if ((clockControl->date.years.yyyy == 0) || (clockControl->date.years.yyyy >= UPPER_TOP_YEARS))
-            {
-                clockControl->date.years.yyyy = 0;
-            }
-            break;
-
-        case PLUS:
-            clockControl->date.years.yyyy++;
-            if (clockControl->date.years.yyyy >= UPPER_TOP_YEARS)
+            day = (day - 1) % clockControl->daysInCurrentMonth;
+            if (day < 0)
             {
-                clockControl->date.years.yyyy = UPPER_TOP_YEARS;
+                day += clockControl->daysInCurrentMonth;
             }
-            break;
-
-        default:
-            break;
+            day++;
         }
-        clockControl->date.years.__yy = clockControl->date.years.yyyy % 100;
-        clockControl->date.years.yy__ = clockControl->date.years.yyyy - clockControl->date.years.__yy;
-        break;
+        date->days = day;
+        dateChanged = true;
+    }
+    else if (u == MONTHS)
+    {
+        int16_t month = (date->months - 1) + amount;
+        amount = month / MONTHS_PER_YEAR;
+        month -= amount * MONTHS_PER_YEAR;
+        if (month < 0)
+        {
+            month += MONTHS_PER_YEAR;
+            amount--;
+        }
+        date->months = month + 1;
+        if (carry)
+        {
+            date->years.yyyy += amount;
+        }
+        dateChanged = true;
+    }
+    else if (u == YEARS)
+    {
+        int32_t year = (int32_t)date->years.yyyy + amount;
+        date->years.yyyy = (year < 0) ? 0 : ((year > UPPER_TOP_YEARS) ? UPPER_TOP_YEARS : year);
+        dateChanged = true;
+    }
 
-    default:
-        break;
+    if (dateChanged)
+    {
+        /* Month or year moved under the day, e.g. Mar 31 - 1 month or Feb 29 + 1 year */
+        if (date->days > month_length(date->years.yyyy, date->months))
+        {
+            date->days = month_length(date->years.yyyy, date->months);
+        }
+        clock_deriveFields(clockControl);
     }
 }
+
+void clock_deriveFields(clock_control_t *clockControl)
+{
+    date_ymd_t *date = &clockControl->date;
+
+    clockControl->leapYear = isLeapYear(date->years.yyyy);
+    clockControl->daysInCurrentMonth = calendar_monthLength(date->months, clockControl->leapYear);
+    clockControl->dayOfYear = calendar_dayOfYear(date->years.yyyy, date->months, date->days);
+    clockControl->weekday = (calendar_jan1Weekday(date->years.yyyy) + clockControl->dayOfYear - 1) % DAYS_PER_WEEK;
+    date->years.__yy = date->years.yyyy % 100;
+    date->years.yy__ = date->years.yyyy - date->years.__yy;
+}
+
+void update_clock(clock_control_t *clockControl, const clock_units_t unit, const sign_t sign, const bool affectNextUnit, const bool printTime)
+{
+    clock_add(clockControl, unit, (int16_t)sign - NO_SIGN, affectNextUnit);
+    clock_refreshBCD(clockControl);
+    clock_refreshStrings(clockControl);
+
+    /* The armed alarm was picked against the old time */
+    alarm_reload();
+}
+
+/* Rewrites both strings after the time was set, the tick keeps them current by itself */
+void clock_refreshStrings(clock_control_t *clockControl)
+{
+    char *timeString = clockControl->timeString;
+
+    format_uint(&timeString[0], clockControl->time.hours, 2);
+    timeString[2] = ':';
+    format_uint(&timeString[3], clockControl->time.minutes, 2);
+    timeString[5] = ':';
+    format_uint(&timeString[6], clockControl->time.seconds, 2);
+    timeString[8] = '\0';
+    writeDateString(clockControl);
+}
+
+/* Rebuilds the packed copy after the binary time was set, the tick keeps it in step by itself */
+void clock_refreshBCD(clock_control_t *clockControl)
+{
+#ifdef CLOCK_BCD_CORE
+    clockControl->bcdTime.seconds = DS3231_toBcd(clockControl->time.seconds);
+    clockControl->bcdTime.minutes = DS3231_toBcd(clockControl->time.minutes);
+    clockControl->bcdTime.hours = DS3231_toBcd(clockControl->time.hours);
+#else
+    (void)clockControl;
+#endif /* CLOCK_BCD_CORE */
+}
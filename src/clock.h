@@ -4,6 +4,8 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
+#include <util/atomic.h>
+
 #include <util/delay.h>
 
 #include <stdlib.h>
@@ -11,15 +13,19 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <time.h>
+#include <string.h>
 
 #include "usart.h"
 #include "i2c.h"
 #include "oled.h"
 #include "ds3231.h"
+#include "calendar.h"
+#include "format.h"
 
 #define SECONDS_PER_MINUTE 60
 #define MINUTES_PER_HOUR 60
 #define HOURS_PER_DAY 24
+#define SECONDS_PER_DAY 86400UL
 #define DAYS_PER_MONTH_MAX 31
 #define MONTHS_PER_YEAR 12
 #define UPPER_TOP_YEARS 2999
@@ -36,6 +42,39 @@
 
 #define UART_BAUD_RATE 19200
 
+/* SQW rate in Hz (1, 1024, 4096 or 8192), 1 Hz drives INT0, kHz rates need SQW wired to T1 (PD5) */
+#define TIMEBASE_HZ 1
+
+/* INT/SQW signals DS3231 alarms instead of the 1 Hz heartbeat, the MCU sleeps between wakeups */
+// #define ALARM_WAKEUP
+
+/* Trim the DS3231 aging offset against a 1PPS on INT1 (PD3) or "T<seconds>" lines on the UART */
+// #define AGING_CALIBRATION
+
+/* Date and time layouts for the display and the UART, directives in layout.h */
+#define CLOCK_DATE_LAYOUT "%F" /* or "%d.%m.%Y", "%m/%d/%Y" */
+#define CLOCK_TIME_LAYOUT "%T" /* or "%I:%M:%S %p" */
+
+/* Keep a packed BCD copy of the time, ticked in BCD and fed to the LED driver and RTC as is */
+// #define CLOCK_BCD_CORE
+
+/* The rates are compared numerically here, the DS3231_sqw_rate_t enum is invisible to the preprocessor */
+#if TIMEBASE_HZ == 1
+#define TIMEBASE_MODE DS3231_SQW_1HZ
+#elif TIMEBASE_HZ == 1024
+#define TIMEBASE_MODE DS3231_SQW_1024HZ
+#elif TIMEBASE_HZ == 4096
+#define TIMEBASE_MODE DS3231_SQW_4096HZ
+#elif TIMEBASE_HZ == 8192
+#define TIMEBASE_MODE DS3231_SQW_8192HZ
+#else
+#error "TIMEBASE_HZ must be 1, 1024, 4096 or 8192"
+#endif
+
+#if defined(ALARM_WAKEUP) && (TIMEBASE_HZ != 1)
+#error "ALARM_WAKEUP turns the square wave off, use TIMEBASE_HZ 1"
+#endif
+
 typedef enum
 {
   MINUS,
@@ -103,9 +142,14 @@ typedef struct
   date_ymd_t date;
   uint8_t weekday;
   uint8_t daysInCurrentMonth;
-  char timeString[9];
-  char dateString[11];
-  float temperature;
+  uint16_t dayOfYear;
+  bool leapYear;
+  char timeString[9];  /* "HH:MM:SS", ticked digit by digit */
+  char dateString[11]; /* "YYYY-MM-DD", rewritten on a day change */
+  int16_t temperature; /* Quarter degrees Celsius (Q8.2) */
+#ifdef CLOCK_BCD_CORE
+  time_hms_t bcdTime;  /* Same time as packed BCD, 0x23:0x59:0x59 */
+#endif /* CLOCK_BCD_CORE */
 } clock_control_t;
 
 typedef struct
@@ -120,13 +164,30 @@ typedef struct
     unsigned long lastPressTime;
 } settings_control_t;
 
+typedef struct
+{
+  uint16_t overruns;     /* Heartbeats that found more than one pending tick */
+  uint16_t missedTicks;  /* Ticks folded into a later heartbeat */
+  uint8_t worstBacklog;  /* Most ticks handled by a single heartbeat */
+  uint16_t longestLoop;  /* Slowest heartbeat in ms */
+} heartbeat_stats_t;
+
 void printTime( void );
 void timeToBCD( const time_hms_t timeBuffer, uint8_t *bcdBuffer );
+void packedToBCD( const time_hms_t bcdTime, uint8_t *bcdBuffer );
+void clock_refreshBCD( clock_control_t *clockControl );
+void clock_refreshStrings( clock_control_t *clockControl );
 void clockToLED( uint8_t *buffer );
 void clockToOLED( clock_control_t *clockControl );
 void weekdayToString( uint8_t weekday, char *string );
-void syncControl( uint8_t address, DS3231_buffer_t *buffer, clock_control_t *control );
+void temperatureToString( const int16_t temperature, char *string, const uint8_t decimals );
+void syncControl( uint8_t address, const DS3231_buffer_t *buffer, clock_control_t *control );
+void syncRTC( const clock_control_t *control, DS3231_buffer_t *buffer );
 void update_clock( clock_control_t *clockControl, const clock_units_t unit, const sign_t sign, const bool affectNextUnit, const bool printTime );
+void clock_add( clock_control_t *clockControl, const clock_units_t unit, int16_t amount, const bool carry );
+void clock_deriveFields( clock_control_t *clockControl );
+void clock_tick( clock_control_t *clockControl );
+void clock_snapshot( const clock_control_t *clockControl, clock_control_t *snapshot );
 
 uint8_t init( void );
 uint8_t tickSeconds( clock_control_t *clockControl );
@@ -0,0 +1,110 @@
+#include "clocksync.h"
+#include "timebase.h"
+#include "epoch.h"
+
+void clocksync_init(clock_sync_t *sync, const uint8_t errorBound)
+{
+    sync->offset = 0;
+    sync->drift = 0;
+    sync->interval = CLOCKSYNC_MIN_INTERVAL;
+    sync->lastSync = 0;
+    sync->errorBound = errorBound;
+    sync->synced = false;
+}
+
+bool clocksync_due(const clock_sync_t *sync)
+{
+    return (timebase_seconds() - sync->lastSync) >= sync->interval;
+}
+
+/* Interrupts off, rtc and control must describe the same second when measure is set */
+static void applySample(clock_sync_t *sync, clock_control_t *control, const DS3231_buffer_t *rtc, const bool measure)
+{
+    uint32_t now = timebase_seconds();
+
+#ifdef ALARM_WAKEUP
+    /* The software clock stood still since the last wakeup, there is nothing to measure */
+    (void)measure;
+#else
+    uint32_t elapsed = now - sync->lastSync;
+
+    if (measure && sync->synced && (elapsed > 0))
+    {
+        /* Whole timestamps, a midnight rollover between the two is just one second */
+        int32_t offset = (int32_t)(epoch_fromClock(control) - epoch_fromRTC(rtc));
+        sync->offset = offset;
+
+        /* ppm over this interval, smoothed 3:1 with the previous estimate */
+        int32_t measured = (int32_t)(((int64_t)offset * 1000000L) / elapsed);
+        sync->drift = ((3 * sync->drift) + measured) / 4;
+
+        uint32_t magnitude = (sync->drift < 0) ? -sync->drift : sync->drift;
+        if (offset == 0)
+        {
+            /* Nothing measurable yet, back off */
+            sync->interval <<= 1;
+        }
+        else if (magnitude > 0)
+        {
+            /* Time for the estimated drift to reach the error bound */
+            sync->interval = (sync->errorBound * 1000000UL) / magnitude;
+        }
+        else
+        {
+            sync->interval = CLOCKSYNC_MIN_INTERVAL;
+        }
+
+        if (sync->interval < CLOCKSYNC_MIN_INTERVAL)
+        {
+            sync->interval = CLOCKSYNC_MIN_INTERVAL;
+        }
+        else if (sync->interval > CLOCKSYNC_MAX_INTERVAL)
+        {
+            sync->interval = CLOCKSYNC_MAX_INTERVAL;
+        }
+    }
+#endif /* ALARM_WAKEUP */
+
+    syncControl(DS3231_SECONDS, rtc, control);
+    syncControl(DS3231_MINUTES, rtc, control);
+    syncControl(DS3231_HOURS, rtc, control);
+    syncControl(DS3231_DATE, rtc, control);
+    syncControl(DS3231_MONTH, rtc, control);
+    syncControl(DS3231_YEAR, rtc, control);
+    clock_deriveFields(control);
+    clock_refreshStrings(control);
+
+    sync->lastSync = now;
+    sync->synced = true;
+}
+
+bool clocksync_update(clock_sync_t *sync, clock_control_t *control)
+{
+    for (uint8_t attempt = 1; attempt <= CLOCKSYNC_SAMPLE_ATTEMPTS; attempt++)
+    {
+        /* Both samples must fall between the same two edges, a tick in between reads as a 1 s offset */
+        uint32_t edge = timebase_seconds();
+        DS3231_cacheInvalidate(DS3231_MASK_TIME);
+        DS3231_buffer_t *rtc = DS3231_cacheFetch(DS3231_SECONDS, DS3231_DATETIME_LENGTH);
+        if (rtc == NULL)
+        {
+            /* Nothing was read, the clock keeps its state and the next tick tries again */
+            return false;
+        }
+
+        /* The tick must not run on a half synced clock */
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            bool clean = (timebase_seconds() == edge);
+            if (clean || (attempt == CLOCKSYNC_SAMPLE_ATTEMPTS))
+            {
+                /* Out of attempts the RTC time is still taken, only the drift update is skipped */
+                applySample(sync, control, rtc, clean);
+                control->clockState = RUNNING;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
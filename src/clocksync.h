@@ -0,0 +1,37 @@
+#ifndef CLOCKSYNC_H_
+#define CLOCKSYNC_H_
+
+#include "clock.h"
+
+/* Bounds for the adaptive RTC resync interval, seconds */
+#define CLOCKSYNC_MIN_INTERVAL 60UL
+#define CLOCKSYNC_MAX_INTERVAL 86400UL
+
+/* Allowed error between the software clock and the RTC, seconds */
+#define CLOCKSYNC_ERROR_BOUND 1
+
+/* RTC reads per resync when a tick keeps landing between the RTC and software clock samples */
+#define CLOCKSYNC_SAMPLE_ATTEMPTS 3
+
+typedef struct
+{
+  int32_t offset;    /* Software clock minus RTC at the last resync, seconds */
+  int32_t drift;     /* Smoothed drift estimate, ppm */
+  uint32_t interval; /* Seconds until the next resync */
+  uint32_t lastSync; /* timebase_seconds() at the last resync */
+  uint8_t errorBound;
+  bool synced;
+} clock_sync_t;
+
+void clocksync_init( clock_sync_t *sync, const uint8_t errorBound );
+/*
+ * Reads the RTC, measures the drift and loads the RTC time into control,
+ * which is left RUNNING. Under ALARM_WAKEUP the software clock does not
+ * tick between wakeups, so it is only reloaded and no drift is measured.
+ * Returns false when the RTC could not be read, control is left untouched.
+ */
+bool clocksync_update( clock_sync_t *sync, clock_control_t *control );
+
+bool clocksync_due( const clock_sync_t *sync );
+
+#endif /* CLOCKSYNC_H_ */
@@ -0,0 +1,45 @@
+#include "display.h"
+
+void display_update(display_field_t *field, const char *text)
+{
+    uint8_t width = (field->width > DISPLAY_FIELD_MAX) ? DISPLAY_FIELD_MAX : field->width;
+    char next[DISPLAY_FIELD_MAX];
+    char run[DISPLAY_FIELD_MAX + 1];
+    uint8_t i;
+
+    for (i = 0; i < width; i++)
+    {
+        next[i] = (*text != '\0') ? *text++ : ' ';
+    }
+
+    /* Runs of changed cells, a single unchanged cell is cheaper to resend than a new cursor command */
+    i = 0;
+    while (i < width)
+    {
+        if (!field->dirty && (next[i] == field->shown[i]))
+        {
+            i++;
+            continue;
+        }
+
+        uint8_t start = i;
+        uint8_t length = 0;
+        while ((i < width) && (field->dirty || (next[i] != field->shown[i]) || ((i + 1 < width) && (next[i + 1] != field->shown[i + 1]))))
+        {
+            run[length++] = next[i];
+            field->shown[i] = next[i];
+            i++;
+        }
+        run[length] = '\0';
+
+        oled_gotoxy(field->x + start, field->y);
+        oled_puts(run);
+    }
+
+    field->dirty = false;
+}
+
+void display_invalidate(display_field_t *field)
+{
+    field->dirty = true;
+}
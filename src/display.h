@@ -0,0 +1,26 @@
+#ifndef DISPLAY_H_
+#define DISPLAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "oled.h"
+
+/* Widest field in character cells, one byte of text per cell */
+#define DISPLAY_FIELD_MAX 12
+
+typedef struct
+{
+  uint8_t x;     /* Character column */
+  uint8_t y;     /* Page */
+  uint8_t width; /* Cells owned by the field, shorter text is blanked out */
+  bool dirty;    /* Next update redraws every cell */
+  char shown[DISPLAY_FIELD_MAX];
+} display_field_t;
+
+#define DISPLAY_FIELD(x, y, width) {x, y, width, true, {0}}
+
+void display_update( display_field_t *field, const char *text );
+void display_invalidate( display_field_t *field );
+
+#endif /* DISPLAY_H_ */
@@ -3,66 +3,278 @@
 
 #include "ds3231.h"
 
-static uint8_t addressPtr = 0x00;
+static DS3231_buffer_t shadow;
+static uint32_t shadowValid = 0;
+static uint32_t shadowDirty = 0;
 
-void addressInc()
+uint8_t DS3231_read(uint8_t start, uint8_t length, uint8_t *buffer)
 {
-  addressPtr++;
-  if ( addressPtr >= 0x12 )
+  if ((start >= DS3231_REGISTERS) || (length > DS3231_REGISTERS - start))
   {
-    addressPtr = 0x00;
+    return 1;
   }
+  
+  /* Register pointer and the whole window in one transaction */
+  return i2c_readRegisters(DS3231_ADDRESS, start, buffer, length);
 }
 
+uint8_t DS3231_write(uint8_t start, uint8_t length, const uint8_t *buffer)
+{
+  uint8_t frame[DS3231_REGISTERS + 1];
+  
+  if ((start >= DS3231_REGISTERS) || (length > DS3231_REGISTERS - start))
+  {
+    return 1;
+  }
+  
+  /* Address Pointer followed by the register window */
+  frame[0] = start;
+  for (uint8_t i = 0; i < length; i++)
+  {
+    frame[i + 1] = buffer[i];
+  }
+  
+  i2c_transaction_t transaction = {DS3231_ADDRESS, frame, (uint8_t)(length + 1), NULL, 0, NULL, NULL, I2C_IDLE, 0, 0};
+  if (i2c_transfer(&transaction) != I2C_DONE)
+  {
+    return 1;
+  }
+  
+  /* Keep the shadow coherent with direct writes */
+  for (uint8_t i = 0; i < length; i++)
+  {
+    ((uint8_t *)&shadow)[start + i] = buffer[i];
+    shadowValid |= DS3231_BIT(start + i);
+    shadowDirty &= ~DS3231_BIT(start + i);
+  }
+  
+  return 0;
+}
 
 void DS3231_getAll(DS3231_buffer_t *p_buffer)
 {
-  if(addressPtr != 0x00)
+  DS3231_read(DS3231_SECONDS, sizeof(DS3231_buffer_t), (uint8_t *)p_buffer);
+}
+
+void DS3231_setByte(uint8_t byteToSet, uint8_t value)
+{
+  DS3231_write(byteToSet, 1, &value);
+}
+
+void DS3231_setDateTime(const DS3231_buffer_t *p_buffer)
+{
+  /* Seconds through year, one burst so the RTC never holds a mixed time */
+  DS3231_write(DS3231_SECONDS, DS3231_DATETIME_LENGTH, (const uint8_t *)p_buffer);
+}
+
+void DS3231_cacheTick()
+{
+  /* Time registers advance every second, the temperature is read by temperature.cpp */
+  DS3231_cacheInvalidate(DS3231_MASK_TIME | DS3231_BIT(DS3231_STATUS));
+}
+
+void DS3231_cacheInvalidate(uint32_t mask)
+{
+  /* Pending writes survive until they are flushed */
+  shadowValid &= ~mask | shadowDirty;
+}
+
+void DS3231_cacheSet(uint8_t reg, uint8_t value)
+{
+  if (reg >= DS3231_REGISTERS)
   {
-    addressPtr = 0x00;
-    /* Set DS3231 Address Pointer to the desired address */
-    i2c_start_sla(TW_SLA_W(DS3231_ADDRESS));
-    i2c_write(addressPtr);
-    i2c_stop();
+    return;
   }
   
-  i2c_start_sla(TW_SLA_R(DS3231_ADDRESS));
-  
-  p_buffer->seconds.byte = i2c_readAck();
-  p_buffer->minutes.byte = i2c_readAck();
-  p_buffer->hours.byte = i2c_readAck();
-  p_buffer->days.byte = i2c_readAck();
-  p_buffer->date.byte = i2c_readAck();
-  p_buffer->month_century.byte = i2c_readAck();
-  p_buffer->years.byte = i2c_readAck();
-  p_buffer->a1seconds.byte = i2c_readAck();
-  p_buffer->a1minutes.byte = i2c_readAck();
-  p_buffer->a1hour.byte = i2c_readAck();
-  p_buffer->a1day.byte = i2c_readAck();
-  p_buffer->a2minutes.byte = i2c_readAck();
-  p_buffer->a2hour.byte = i2c_readAck();
-  p_buffer->a2day.byte = i2c_readAck();
-  p_buffer->control.byte = i2c_readAck();
-  p_buffer->control_status.byte = i2c_readAck();
-  p_buffer->aging.byte = i2c_readAck();
-  p_buffer->temp_msb.byte = i2c_readAck();
-  p_buffer->temp_lsb.byte = i2c_readNAck();
-  
-  i2c_stop();  
+  ((uint8_t *)&shadow)[reg] = value;
+  shadowValid |= DS3231_BIT(reg);
+  shadowDirty |= DS3231_BIT(reg);
 }
 
-void DS3231_setByte(uint8_t byteToSet, uint8_t value)
+uint8_t DS3231_cacheGet(uint8_t reg)
+{
+  if (reg >= DS3231_REGISTERS)
+  {
+    return 0;
+  }
+  
+  /* A failed read leaves the last known value, which is the best guess for a read-modify-write */
+  DS3231_cacheFetch(reg, 1);
+  return ((uint8_t *)&shadow)[reg];
+}
+
+uint8_t DS3231_cacheFlush()
+{
+  uint8_t result = 0;
+  uint8_t reg = 0;
+  
+  /* One burst per contiguous run of dirty registers */
+  while (shadowDirty && (reg < DS3231_REGISTERS))
+  {
+    if (!(shadowDirty & DS3231_BIT(reg)))
+    {
+      reg++;
+      continue;
+    }
+    
+    uint8_t start = reg;
+    uint32_t run = 0;
+    while ((reg < DS3231_REGISTERS) && (shadowDirty & DS3231_BIT(reg)))
+    {
+      run |= DS3231_BIT(reg);
+      reg++;
+    }
+    
+    /* DS3231_write cleans the run on success, a failed run is dropped so the next get reads the RTC again */
+    if (DS3231_write(start, reg - start, &((uint8_t *)&shadow)[start]) != 0)
+    {
+      shadowDirty &= ~run;
+      shadowValid &= ~run;
+      result = 1;
+    }
+  }
+  
+  return result;
+}
+
+DS3231_buffer_t *DS3231_cacheFetch(uint8_t start, uint8_t length)
 {
+  uint8_t first = 0xFF;
+  uint8_t last = 0;
   
-  /* Set DS3231 Address Pointer to the desired address */
-  i2c_start_sla(TW_SLA_W(DS3231_ADDRESS));
-  i2c_write(byteToSet);
+  if ((start >= DS3231_REGISTERS) || (length > DS3231_REGISTERS - start))
+  {
+    return NULL;
+  }
+  
+  /* Smallest window that covers every stale register in the range */
+  for (uint8_t reg = start; reg < start + length; reg++)
+  {
+    if (!(shadowValid & DS3231_BIT(reg)))
+    {
+      if (first == 0xFF)
+      {
+        first = reg;
+      }
+      last = reg;
+    }
+  }
   
-  /* Set the desired value to the address set */
-  i2c_write(value);
-  i2c_stop();
+  if (first != 0xFF)
+  {
+    uint8_t window[DS3231_REGISTERS];
+    uint8_t windowLength = last - first + 1;
+    
+    if (DS3231_read(first, windowLength, window) != 0)
+    {
+      /* The range still holds stale registers */
+      return NULL;
+    }
+    
+    /* Dirty registers keep their pending value */
+    for (uint8_t i = 0; i < windowLength; i++)
+    {
+      if (!(shadowDirty & DS3231_BIT(first + i)))
+      {
+        ((uint8_t *)&shadow)[first + i] = window[i];
+        shadowValid |= DS3231_BIT(first + i);
+      }
+    }
+  }
   
-  addressInc();
+  return &shadow;
+}
+
+uint8_t DS3231_toBcd(uint8_t value)
+{
+  uint8_t tens = value / 10;
+  return (tens << 4) | (value - (tens * 10));
+}
+
+/* Registers from the finest unit up, each gets AxMy set while it is not matched */
+static void setAlarmRegisters(uint8_t reg, uint8_t count, uint8_t matched, DS3231_alarm_mode_t mode, const uint8_t *values)
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    uint8_t value = DS3231_toBcd(values[i]);
+    if (i >= matched)
+    {
+      value |= DS3231_AM;
+    }
+    DS3231_cacheSet(reg + i, value);
+  }
+  
+  if (mode == DS3231_ALARM_DAY)
+  {
+    DS3231_cacheSet(reg + count - 1, DS3231_cacheGet(reg + count - 1) | DS3231_DYDT);
+  }
+  
+  DS3231_cacheFlush();
+}
+
+void DS3231_setAlarm1(DS3231_alarm_mode_t mode, uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+  static const uint8_t matched[] = {0, 1, 2, 3, 4, 4};
+  uint8_t values[] = {seconds, minutes, hours, day};
+  
+  setAlarmRegisters(DS3231_A1S, sizeof(values), matched[mode], mode, values);
+}
+
+void DS3231_setAlarm2(DS3231_alarm_mode_t mode, uint8_t day, uint8_t hours, uint8_t minutes)
+{
+  /* No seconds register, DS3231_ALARM_SECONDS behaves like DS3231_ALARM_EVERY */
+  static const uint8_t matched[] = {0, 0, 1, 2, 3, 3};
+  uint8_t values[] = {minutes, hours, day};
+  
+  setAlarmRegisters(DS3231_A2M, sizeof(values), matched[mode], mode, values);
+}
+
+void DS3231_setAlarmInterrupts(uint8_t enable)
+{
+  bitfield8_t control;
+  control.byte = DS3231_cacheGet(DS3231_CONTROL) & ~(DS3231_A1IE | DS3231_A2IE | DS3231_INTCN);
+  
+  /* INT/SQW switches from square wave to alarm output while any alarm is enabled */
+  if (enable)
+  {
+    control.byte |= DS3231_INTCN | (enable & (DS3231_A1IE | DS3231_A2IE));
+  }
+  
+  DS3231_cacheSet(DS3231_CONTROL, control.byte);
+  DS3231_cacheFlush();
+}
+
+void DS3231_setSquareWave(DS3231_sqw_rate_t rate)
+{
+  uint8_t control = DS3231_cacheGet(DS3231_CONTROL) & ~(DS3231_RS1 | DS3231_RS2 | DS3231_INTCN);
+  
+  DS3231_cacheSet(DS3231_CONTROL, control | rate);
+  DS3231_cacheFlush();
+}
+
+void DS3231_forceConversion()
+{
+  uint8_t control = DS3231_cacheGet(DS3231_CONTROL) | DS3231_CONV;
+  
+  /* CONV clears itself once the conversion is done, do not keep it in the shadow */
+  DS3231_write(DS3231_CONTROL, 1, &control);
+  DS3231_cacheInvalidate(DS3231_BIT(DS3231_CONTROL));
+}
+
+uint8_t DS3231_checkAlarms()
+{
+  DS3231_cacheInvalidate(DS3231_BIT(DS3231_STATUS));
+  uint8_t status = DS3231_cacheGet(DS3231_STATUS);
+  uint8_t fired = status & (DS3231_A1F | DS3231_A2F);
+  
+  /* Flags hold INT low until cleared, writing 1 leaves a flag untouched */
+  if (fired)
+  {
+    DS3231_cacheSet(DS3231_STATUS, (status | DS3231_A1F | DS3231_A2F) & ~fired);
+    DS3231_cacheFlush();
+  }
+  
+  return fired;
 }
 
 bool DS3231_getAMPM()
@@ -87,23 +299,8 @@ uint8_t DS3231_getByte(uint8_t byteToGet)
 {
   uint8_t buffer = 0;
   
-  if(addressPtr != byteToGet)
-  {
-    addressPtr = byteToGet;
-    /* Set DS3231 Address Pointer to the desired address */
-    i2c_start_sla(TW_SLA_W(DS3231_ADDRESS));
-    i2c_write(byteToGet);
-    i2c_stop();
-  }
-  else
-  {
-    /* Request one byte and send NACK to end transmission */
-    i2c_start_sla(TW_SLA_R(DS3231_ADDRESS));
-    buffer = i2c_readNAck();
-    i2c_stop();
-  }
+  DS3231_read(byteToGet, 1, &buffer);
   
-  addressInc();
   return buffer;
 }
 
@@ -116,30 +313,10 @@ uint8_t DS3231_getMonth()
   return buffer.byte;
 }
 
-float DS3231_getTemp()
+int16_t DS3231_decodeTemp(uint8_t msb, uint8_t lsb)
 {
-
-  uint8_t tMSB, tLSB;
-  float temp;
-  
-  if(addressPtr != DS3231_TEMP_MSB)
-  {
-    addressPtr = DS3231_TEMP_MSB;
-    /* Set DS3231 Address Pointer to the desired address */
-    i2c_start_sla(TW_SLA_W(DS3231_ADDRESS));
-    i2c_write(DS3231_TEMP_MSB);
-    i2c_stop();
-  }
-  
-  i2c_start_sla(TW_SLA_R(DS3231_ADDRESS));
-  tMSB = i2c_readAck();
-  addressInc();
-  tLSB = i2c_readNAck();
-  addressInc();
-  i2c_stop();
-  
-  int16_t _temp = ( tMSB << 8 | (tLSB & 0xC0) );  // Shift upper byte, add lower
-  temp = ( (float) _temp / 256.0 );              // Scale and return
+  /* 10 bit two's complement, MSB holds whole degrees, LSB bits 7-6 the quarters */
+  int16_t _temp = ( msb << 8 | (lsb & 0xC0) );
   
-  return temp;
+  return _temp >> 6;
 }
@@ -21,6 +21,33 @@
 #define DS3231_AGING     0x10U
 #define DS3231_TEMP_MSB  0x11U
 #define DS3231_TEMP_lSB  0x12U
+#define DS3231_REGISTERS 0x13U
+#define DS3231_DATETIME_LENGTH 7U
+
+/* Control register */
+#define DS3231_A1IE      0x01U
+#define DS3231_A2IE      0x02U
+#define DS3231_INTCN     0x04U
+#define DS3231_RS1       0x08U
+#define DS3231_RS2       0x10U
+#define DS3231_CONV      0x20U
+
+/* Status register */
+#define DS3231_A1F       0x01U
+#define DS3231_A2F       0x02U
+#define DS3231_BSY       0x04U
+
+/* Alarm mask bit (AxMy) and day/date select in the alarm registers */
+#define DS3231_AM        0x80U
+#define DS3231_DYDT      0x40U
+
+#define DS3231_BIT(reg)  (1UL << (reg))
+#define DS3231_MASK_TIME (DS3231_BIT(DS3231_SECONDS) | DS3231_BIT(DS3231_MINUTES) | DS3231_BIT(DS3231_HOURS) | \
+                          DS3231_BIT(DS3231_DAYS) | DS3231_BIT(DS3231_DATE) | DS3231_BIT(DS3231_MONTH) | DS3231_BIT(DS3231_YEAR))
+#define DS3231_MASK_ALL  (DS3231_BIT(DS3231_REGISTERS) - 1UL)
+
+/* Temperature registers are refreshed by a conversion every 64 s */
+#define DS3231_TEMP_PERIOD 64U
 
 #include <stdbool.h>
 #include "i2c.h"
@@ -43,6 +70,24 @@ typedef union {
   } bits;
 } bitfield8_t;
 
+typedef enum
+{
+  DS3231_ALARM_EVERY,   /* A1: once per second, A2: once per minute */
+  DS3231_ALARM_SECONDS, /* A1 only: seconds match */
+  DS3231_ALARM_MINUTES, /* minutes (and seconds) match */
+  DS3231_ALARM_HOURS,   /* hours, minutes (and seconds) match */
+  DS3231_ALARM_DATE,    /* date, hours, minutes (and seconds) match */
+  DS3231_ALARM_DAY      /* weekday, hours, minutes (and seconds) match */
+} DS3231_alarm_mode_t;
+
+typedef enum
+{
+  DS3231_SQW_1HZ = 0,
+  DS3231_SQW_1024HZ = DS3231_RS1,
+  DS3231_SQW_4096HZ = DS3231_RS2,
+  DS3231_SQW_8192HZ = DS3231_RS1 | DS3231_RS2
+} DS3231_sqw_rate_t;
+
 typedef struct
 {
   bitfield8_t seconds;
@@ -66,9 +111,29 @@ typedef struct
   bitfield8_t temp_lsb;
 } DS3231_buffer_t;
 
-void addressInc( void );
 void DS3231_getAll( DS3231_buffer_t *p_buffer );
 void DS3231_setByte( uint8_t byteToSet, uint8_t value );
+void DS3231_setDateTime( const DS3231_buffer_t *p_buffer );
+
+uint8_t DS3231_read( uint8_t start, uint8_t length, uint8_t *buffer );
+uint8_t DS3231_write( uint8_t start, uint8_t length, const uint8_t *buffer );
+
+/* Write-back shadow of the register map */
+void DS3231_cacheTick( void );
+void DS3231_cacheInvalidate( uint32_t mask );
+void DS3231_cacheSet( uint8_t reg, uint8_t value );
+uint8_t DS3231_cacheGet( uint8_t reg );
+uint8_t DS3231_cacheFlush( void );
+/* NULL when the range is out of the register map or the RTC could not be read */
+DS3231_buffer_t *DS3231_cacheFetch( uint8_t start, uint8_t length );
+
+void DS3231_setAlarm1( DS3231_alarm_mode_t mode, uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds );
+void DS3231_setAlarm2( DS3231_alarm_mode_t mode, uint8_t day, uint8_t hours, uint8_t minutes );
+void DS3231_setAlarmInterrupts( uint8_t enable );
+void DS3231_setSquareWave( DS3231_sqw_rate_t rate );
+void DS3231_forceConversion( void );
+uint8_t DS3231_checkAlarms( void );
+uint8_t DS3231_toBcd( uint8_t value );
 
 bool DS3231_getAMPM( void );
 bool DS3231_getCentury( void );
@@ -76,6 +141,7 @@ bool DS3231_getCentury( void );
 uint8_t DS3231_getByte( uint8_t byteToGet );
 uint8_t DS3231_getMonth( void );
 
-float DS3231_getTemp( void );
+/* Temperature registers to quarter degrees Celsius (Q8.2) */
+int16_t DS3231_decodeTemp( uint8_t msb, uint8_t lsb );
 
 #endif /* DS3231_H_ */
\ No newline at end of file
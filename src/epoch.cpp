@@ -0,0 +1,101 @@
+#include "epoch.h"
+
+epoch_t epoch_fromDateTime(const date_ymd_t *date, const time_hms_t *time)
+{
+    uint16_t days = calendar_daysBeforeYear(date->years.yyyy) + calendar_dayOfYear(date->years.yyyy, date->months, date->days) - 1;
+    uint16_t minutes = (time->hours * MINUTES_PER_HOUR) + time->minutes;
+
+    return (days * SECONDS_PER_DAY) + (minutes * (uint32_t)SECONDS_PER_MINUTE) + time->seconds;
+}
+
+epoch_t epoch_fromClock(const clock_control_t *clockControl)
+{
+    return epoch_fromDateTime(&clockControl->date, &clockControl->time);
+}
+
+epoch_t epoch_fromRTC(const DS3231_buffer_t *buffer)
+{
+    clock_control_t rtcTime = {};
+
+    /* Same decoding and order as a resync, the year looks up the month length so the month goes first */
+    syncControl(DS3231_SECONDS, buffer, &rtcTime);
+    syncControl(DS3231_MINUTES, buffer, &rtcTime);
+    syncControl(DS3231_HOURS, buffer, &rtcTime);
+    syncControl(DS3231_DATE, buffer, &rtcTime);
+    syncControl(DS3231_MONTH, buffer, &rtcTime);
+    syncControl(DS3231_YEAR, buffer, &rtcTime);
+
+    return epoch_fromClock(&rtcTime);
+}
+
+void epoch_toDateTime(const epoch_t epoch, date_ymd_t *date, time_hms_t *time)
+{
+    uint16_t days = epoch / SECONDS_PER_DAY;
+    uint32_t secondsOfDay = epoch - (days * SECONDS_PER_DAY);
+
+    /* Two 32 bit divisions, the rest fits 16 bits */
+    uint16_t minutes = secondsOfDay / SECONDS_PER_MINUTE;
+    time->seconds = secondsOfDay - (minutes * (uint32_t)SECONDS_PER_MINUTE);
+    time->hours = minutes / MINUTES_PER_HOUR;
+    time->minutes = minutes - (time->hours * MINUTES_PER_HOUR);
+
+    /* 366 days per year is at most one year early within the epoch */
+    uint16_t year = CALENDAR_BASE_YEAR + (days / (DAYS_PER_YEAR + 1));
+    while (calendar_daysBeforeYear(year + 1) <= days)
+    {
+        year++;
+    }
+
+    date->years.yyyy = year;
+    date->years.__yy = year % 100;
+    date->years.yy__ = year - date->years.__yy;
+    calendar_monthDay(days - calendar_daysBeforeYear(year) + 1, isLeapYear(year), &date->months, &date->days);
+}
+
+void epoch_toClock(const epoch_t epoch, clock_control_t *clockControl)
+{
+    epoch_toDateTime(epoch, &clockControl->date, &clockControl->time);
+    clock_deriveFields(clockControl);
+    clock_refreshBCD(clockControl);
+    clock_refreshStrings(clockControl);
+}
+
+void epoch_toRTC(const epoch_t epoch, DS3231_buffer_t *buffer)
+{
+    date_ymd_t date;
+    time_hms_t time;
+
+    epoch_toDateTime(epoch, &date, &time);
+
+    buffer->seconds.byte = DS3231_toBcd(time.seconds);
+    buffer->minutes.byte = DS3231_toBcd(time.minutes);
+    buffer->hours.byte = DS3231_toBcd(time.hours);
+    buffer->days.byte = epoch_weekday(epoch) + 1;
+    buffer->date.byte = DS3231_toBcd(date.days);
+    buffer->month_century.byte = DS3231_toBcd(date.months);
+    buffer->month_century.bits.b7 = (date.years.yyyy >= 2100U);
+    buffer->years.byte = DS3231_toBcd(date.years.__yy);
+}
+
+uint8_t epoch_weekday(const epoch_t epoch)
+{
+    /* 2000-01-01 was a Saturday */
+    return ((uint16_t)(epoch / SECONDS_PER_DAY) + SATURDAY) % DAYS_PER_WEEK;
+}
+
+epoch_precise_t epoch_precise(const epoch_t seconds, const uint16_t ticks, const uint16_t ticksPerSecond)
+{
+    epoch_precise_t precise;
+
+    precise.seconds = seconds;
+    precise.fraction = ((uint32_t)ticks << 16) / ticksPerSecond;
+    return precise;
+}
+
+int32_t epoch_diffMillis(const epoch_precise_t *later, const epoch_precise_t *earlier)
+{
+    int32_t seconds = later->seconds - earlier->seconds;
+    int32_t fraction = (int32_t)later->fraction - earlier->fraction;
+
+    return (seconds * 1000L) + ((fraction * 1000L) >> 16);
+}
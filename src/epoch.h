@@ -0,0 +1,28 @@
+#ifndef EPOCH_H_
+#define EPOCH_H_
+
+#include "clock.h"
+
+/* Seconds since 2000-01-01 00:00:00, the avr-libc time_t epoch, runs until 2136 */
+typedef uint32_t epoch_t;
+
+typedef struct
+{
+  epoch_t seconds;
+  uint16_t fraction; /* 1/65536 s */
+} epoch_precise_t;
+
+epoch_t epoch_fromDateTime( const date_ymd_t *date, const time_hms_t *time );
+epoch_t epoch_fromClock( const clock_control_t *clockControl );
+epoch_t epoch_fromRTC( const DS3231_buffer_t *buffer );
+
+void epoch_toDateTime( const epoch_t epoch, date_ymd_t *date, time_hms_t *time );
+void epoch_toClock( const epoch_t epoch, clock_control_t *clockControl );
+void epoch_toRTC( const epoch_t epoch, DS3231_buffer_t *buffer );
+
+uint8_t epoch_weekday( const epoch_t epoch );
+
+epoch_precise_t epoch_precise( const epoch_t seconds, const uint16_t ticks, const uint16_t ticksPerSecond );
+int32_t epoch_diffMillis( const epoch_precise_t *later, const epoch_precise_t *earlier );
+
+#endif /* EPOCH_H_ */
@@ -0,0 +1,128 @@
+#include <avr/pgmspace.h>
+
+#include "format.h"
+
+#define FORMAT_DIGITS 10
+#define FORMAT_MAX_DECIMALS 4
+
+static const uint32_t powersOfTen[FORMAT_DIGITS] PROGMEM = {1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL, 1000UL, 100UL, 10UL, 1UL};
+
+char *format_uint(char *string, uint32_t value, const uint8_t width)
+{
+    bool leading = true;
+
+    /* Digits by subtraction, no 32 bit division on the AVR */
+    for (uint8_t i = 0; i < FORMAT_DIGITS; i++)
+    {
+        uint32_t power = pgm_read_dword(&powersOfTen[i]);
+        char digit = '0';
+        while (value >= power)
+        {
+            value -= power;
+            digit++;
+        }
+
+        /* Zeros are padding only inside width, the last digit always shows */
+        if (leading && (digit == '0') && ((FORMAT_DIGITS - i) > width) && (i < FORMAT_DIGITS - 1))
+        {
+            continue;
+        }
+        leading = false;
+        *string++ = digit;
+    }
+    return string;
+}
+
+char *format_int(char *string, const int32_t value, const uint8_t width)
+{
+    /* Like %0*d the sign counts towards width */
+    if (value < 0)
+    {
+        *string++ = '-';
+        return format_uint(string, -(uint32_t)value, width ? (width - 1) : 0);
+    }
+    return format_uint(string, value, width);
+}
+
+char *format_bcd(char *string, const uint8_t bcd)
+{
+    *string++ = '0' + (bcd >> 4);
+    *string++ = '0' + (bcd & 0x0F);
+    return string;
+}
+
+char *format_fixed(char *string, const int32_t value, const uint8_t fractionBits, uint8_t decimals)
+{
+    uint32_t magnitude = (value < 0) ? -(uint32_t)value : value;
+    uint32_t whole = magnitude >> fractionBits;
+    uint32_t fraction = magnitude & ((1UL << fractionBits) - 1);
+    uint16_t scale = 1;
+
+    if (decimals > FORMAT_MAX_DECIMALS)
+    {
+        decimals = FORMAT_MAX_DECIMALS;
+    }
+    for (uint8_t i = 0; i < decimals; i++)
+    {
+        scale *= 10;
+    }
+
+    /*
+     * Round half to even like printf, the value is exact in binary so ties
+     * are real ties. Rounding up may carry into the whole part.
+     */
+    uint32_t scaled = fraction * scale;
+    uint32_t remainder = scaled & ((1UL << fractionBits) - 1);
+    uint32_t half = (1UL << fractionBits) >> 1;
+    fraction = scaled >> fractionBits;
+    bool odd = (decimals ? fraction : whole) & 1;
+    if (fractionBits && ((remainder > half) || ((remainder == half) && odd)))
+    {
+        fraction++;
+    }
+    if (fraction >= scale)
+    {
+        fraction -= scale;
+        whole++;
+    }
+
+    /* A negative value keeps its sign even when it rounds to zero, "-0.0" as printf has it */
+    if (value < 0)
+    {
+        *string++ = '-';
+    }
+    string = format_uint(string, whole, 1);
+    if (decimals)
+    {
+        *string++ = '.';
+        string = format_uint(string, fraction, decimals);
+    }
+    return string;
+}
+
+char *format_string_P(char *string, const char *progmem_s)
+{
+    char c;
+
+    while ((c = pgm_read_byte(progmem_s++)) != '\0')
+    {
+        *string++ = c;
+    }
+    return string;
+}
+
+void format_putUint(format_sink_t sink, const uint32_t value, const uint8_t width)
+{
+    char buffer[FORMAT_MAX_LENGTH + 1];
+
+    *format_uint(buffer, value, width) = '\0';
+    sink(buffer);
+}
+
+void format_putInt(format_sink_t sink, const int32_t value, const uint8_t width)
+{
+    char buffer[FORMAT_MAX_LENGTH + 1];
+
+    *format_int(buffer, value, width) = '\0';
+    sink(buffer);
+}
@@ -0,0 +1,28 @@
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Longest output of one emitter, "-2147483648.0000" from format_fixed */
+#define FORMAT_MAX_LENGTH 16
+
+/* Receives a terminated string, uart0_puts and oled_puts fit */
+typedef void (*format_sink_t)( const char *string );
+
+/*
+ * Emitters write at most FORMAT_MAX_LENGTH characters without a terminator
+ * and return the end, so calls chain into one caller buffer. width zero pads
+ * up to 10 digits and counts the sign like %0*d, 0 prints the shortest form.
+ * format_fixed rounds half to even and prints what %.*f prints.
+ */
+char *format_uint( char *string, uint32_t value, const uint8_t width );
+char *format_int( char *string, const int32_t value, const uint8_t width );
+char *format_bcd( char *string, const uint8_t bcd );
+char *format_fixed( char *string, const int32_t value, const uint8_t fractionBits, uint8_t decimals ); /* fractionBits <= 16, decimals <= 4 */
+char *format_string_P( char *string, const char *progmem_s );
+
+void format_putUint( format_sink_t sink, const uint32_t value, const uint8_t width );
+void format_putInt( format_sink_t sink, const int32_t value, const uint8_t width );
+
+#endif /* FORMAT_H_ */
@@ -8,6 +8,9 @@
 
 #include "i2c.h"
 
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
 #if defined (__AVR_ATmega328__) || defined(__AVR_ATmega328P__) || \
 defined(__AVR_ATmega168P__) || defined(__AVR_ATmega168PA__) || \
 defined(__AVR_ATmega88P__) || \
@@ -26,6 +29,29 @@ defined (__AVR_ATmega2560__)
 
 uint8_t I2C_ErrorCode;
 
+#define I2C_QUEUE_MASK	(I2C_QUEUE_SIZE - 1)
+#if (I2C_QUEUE_SIZE & I2C_QUEUE_MASK) != 0
+#error "I2C_QUEUE_SIZE must be power of 2 !"
+#endif
+
+static i2c_transaction_t * volatile queue[I2C_QUEUE_SIZE];
+static volatile uint8_t queueHead;
+static volatile uint8_t queueCount;
+static volatile uint8_t busEvents;
+static uint8_t writeIndex;
+static uint8_t readIndex;
+static uint16_t (*clockSource)(void);
+
+#if I2C_TIMEOUT > 65535UL
+#error "I2C_TIMEOUT does not fit 16 bits, lower it"
+#endif
+
+/* state of one blocking wait, see i2c_spin */
+typedef struct {
+    uint8_t events;
+    uint16_t idle;
+} i2c_watchdog_t;
+
 
 /**********************************************
  Public Function: i2c_init
@@ -67,6 +93,7 @@ void i2c_init(void){
  Return Value: none
  **********************************************/
 void i2c_start(){
+    i2c_wait();
     uint16_t timeout = F_CPU/F_I2C*2.0;
     // i2c start
     TWCR = (1 << TWINT)|(1 << TWSTA)|(1 << TWEN);
@@ -119,6 +146,7 @@ void i2c_write_sla( uint8_t i2c_addr ){
  Return Value: none
  **********************************************/
 void i2c_start_sla(uint8_t i2c_addr){
+    i2c_wait();
     // i2c start
     TWCR = (1 << TWINT)|(1 << TWSTA)|(1 << TWEN);
 	uint16_t timeout = F_CPU/F_I2C*2.0;
@@ -230,6 +258,269 @@ uint8_t i2c_readNAck(void){
 	};
     return TWDR;
 }
+
+static uint16_t i2c_now(void){
+    return clockSource ? clockSource() : 0;
+}
+
+/* make queue[queueHead] the active transaction */
+static void i2c_load(void){
+    i2c_transaction_t *transaction = queue[queueHead];
+    transaction->status = I2C_ACTIVE;
+    transaction->startTime = i2c_now();
+    writeIndex = 0;
+    readIndex = 0;
+}
+
+/* release the bus, start the next transaction and notify the owner */
+static void i2c_finish(i2c_status_t status){
+    i2c_transaction_t *transaction = queue[queueHead];
+    queueHead = (queueHead + 1) & I2C_QUEUE_MASK;
+    queueCount--;
+    if (queueCount) {
+        // stop followed by start of the next transaction
+        i2c_load();
+        TWCR = (1 << TWINT)|(1 << TWSTO)|(1 << TWSTA)|(1 << TWEN)|(1 << TWIE);
+    } else {
+        TWCR = (1 << TWINT)|(1 << TWSTO)|(1 << TWEN);
+    }
+    if (status != I2C_DONE) {
+        I2C_ErrorCode |= (1 << I2C_TRANSACTION);
+    }
+    transaction->duration = i2c_now() - transaction->startTime;
+    transaction->status = status;
+    if (transaction->callback) {
+        transaction->callback(transaction);
+    }
+}
+
+/* advance the active transaction by one bus event, TWINT must be set */
+static void i2c_service(void){
+    i2c_transaction_t *transaction = queue[queueHead];
+    busEvents++;
+    switch (TW_STATUS) {
+        case TW_START:
+        case TW_REP_START:
+            if (writeIndex < transaction->writeLength || transaction->readLength == 0) {
+                TWDR = TW_SLA_W(transaction->address);
+            } else {
+                TWDR = TW_SLA_R(transaction->address);
+            }
+            TWCR = (1 << TWINT)|(1 << TWEN)|(1 << TWIE);
+            break;
+        case TW_MT_SLA_ACK:
+        case TW_MT_DATA_ACK:
+            if (writeIndex < transaction->writeLength) {
+                TWDR = transaction->writeBuffer[writeIndex++];
+                TWCR = (1 << TWINT)|(1 << TWEN)|(1 << TWIE);
+            } else if (transaction->readLength) {
+                // repeated start, switch to master receiver
+                TWCR = (1 << TWINT)|(1 << TWSTA)|(1 << TWEN)|(1 << TWIE);
+            } else {
+                i2c_finish(I2C_DONE);
+            }
+            break;
+        case TW_MR_DATA_ACK:
+            transaction->readBuffer[readIndex++] = TWDR;
+            // fall through
+        case TW_MR_SLA_ACK:
+            if (readIndex + 1 < transaction->readLength) {
+                TWCR = (1 << TWINT)|(1 << TWEN)|(1 << TWIE)|(1 << TWEA);
+            } else {
+                // nack the last byte
+                TWCR = (1 << TWINT)|(1 << TWEN)|(1 << TWIE);
+            }
+            break;
+        case TW_MR_DATA_NACK:
+            transaction->readBuffer[readIndex++] = TWDR;
+            i2c_finish(I2C_DONE);
+            break;
+        case TW_MT_ARB_LOST:
+            // restart the whole transaction once the bus is free
+            writeIndex = 0;
+            readIndex = 0;
+            TWCR = (1 << TWINT)|(1 << TWSTA)|(1 << TWEN)|(1 << TWIE);
+            break;
+        case TW_MT_SLA_NACK:
+        case TW_MT_DATA_NACK:
+        case TW_MR_SLA_NACK:
+            i2c_finish(I2C_NACK);
+            break;
+        default:
+            i2c_finish(I2C_BUSERROR);
+            break;
+    }
+}
+
+/* drive the engine by hand while global interrupts are disabled (init code) */
+static void i2c_poll(void){
+    if (!(SREG & (1 << SREG_I)) && (TWCR & (1 << TWINT))) {
+        i2c_service();
+    }
+}
+
+ISR(TWI_vect){
+    i2c_service();
+}
+
+/* drop the active transaction, resetting the TWI releases SDA and SCL in any state */
+static void i2c_abort(void){
+    TWCR = 0;
+    i2c_finish(I2C_BUSERROR);
+}
+
+/* one poll of a blocking wait, the active transaction is aborted after I2C_TIMEOUT polls without a bus event */
+static void i2c_spin(i2c_watchdog_t *watchdog){
+    i2c_poll();
+    if (watchdog->events != busEvents) {
+        watchdog->events = busEvents;
+        watchdog->idle = 0;
+        return;
+    }
+    if (++watchdog->idle < I2C_TIMEOUT) {
+        return;
+    }
+    watchdog->idle = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        // the interrupt may have moved the engine on since the check above
+        if (queueCount && watchdog->events == busEvents) {
+            i2c_abort();
+        }
+    }
+}
+
+/**********************************************
+ Public Function: i2c_enqueue
+ 
+ Purpose: Queue a transaction for the interrupt
+    driven TWI engine. The descriptor and its
+    buffers must stay valid until the status
+    leaves I2C_QUEUED/I2C_ACTIVE.
+ 
+ Input Parameter:
+ - i2c_transaction_t *transaction: descriptor
+ 
+ Return Value: uint8_t
+  - 0: transaction queued
+  - 1: queue full
+ **********************************************/
+uint8_t i2c_enqueue(i2c_transaction_t *transaction){
+    uint8_t idle;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if (queueCount >= I2C_QUEUE_SIZE) {
+            return 1;
+        }
+        transaction->status = I2C_QUEUED;
+        queue[(queueHead + queueCount) & I2C_QUEUE_MASK] = transaction;
+        queueCount++;
+        idle = (queueCount == 1);
+        if (idle) {
+            i2c_load();
+        }
+    }
+    if (idle) {
+        // a stop may still be on the bus, TWIE is off so nothing else touches TWCR meanwhile
+        uint16_t timeout = I2C_TIMEOUT;
+        while ((TWCR & (1 << TWSTO)) && --timeout);
+        TWCR = (1 << TWINT)|(1 << TWSTA)|(1 << TWEN)|(1 << TWIE);
+    }
+    return 0;
+}
+
+/**********************************************
+ Public Function: i2c_transfer
+ 
+ Purpose: Blocking wrapper around i2c_enqueue,
+    usable with interrupts disabled. A bus that
+    shows no event for I2C_TIMEOUT polls aborts
+    the transaction with I2C_BUSERROR
+ 
+ Input Parameter:
+ - i2c_transaction_t *transaction: descriptor
+ 
+ Return Value: i2c_status_t
+  - I2C_DONE, I2C_NACK or I2C_BUSERROR
+ **********************************************/
+i2c_status_t i2c_transfer(i2c_transaction_t *transaction){
+    i2c_watchdog_t watchdog = {busEvents, 0};
+    while (i2c_enqueue(transaction)) {
+        i2c_spin(&watchdog);
+    }
+    while (transaction->status == I2C_QUEUED || transaction->status == I2C_ACTIVE) {
+        i2c_spin(&watchdog);
+    }
+    return transaction->status;
+}
+
+/**********************************************
+ Public Function: i2c_queueDepth
+ 
+ Purpose: Number of transactions queued or
+    currently on the bus
+ 
+ Input Parameter: none
+ 
+ Return Value: uint8_t
+ **********************************************/
+uint8_t i2c_queueDepth(void){
+    return queueCount;
+}
+
+/**********************************************
+ Public Function: i2c_wait
+ 
+ Purpose: Wait until all queued transactions
+    are done, called by the blocking api. Stuck
+    transactions are aborted like in i2c_transfer
+ 
+ Input Parameter: none
+ 
+ Return Value: none
+ **********************************************/
+void i2c_wait(void){
+    i2c_watchdog_t watchdog = {busEvents, 0};
+    while (queueCount) {
+        i2c_spin(&watchdog);
+    }
+}
+
+/**********************************************
+ Public Function: i2c_setClockSource
+ 
+ Purpose: Set the free running counter used to
+    measure transaction duration
+ 
+ Input Parameter:
+ - uint16_t (*clock)(void): counter read, NULL
+    disables timing
+ 
+ Return Value: none
+ **********************************************/
+void i2c_setClockSource(uint16_t (*clock)(void)){
+    clockSource = clock;
+}
+
+/**********************************************
+ Public Function: i2c_readRegisters
+ 
+ Purpose: Set the register pointer of a device
+    and read from it after a repeated start,
+    all in one bus transaction
+ 
+ Input Parameter:
+ - uint8_t i2c_addr: 7 bit adress of device
+ - uint8_t reg: first register to read
+ - uint8_t *buffer: destination
+ - uint8_t length: number of bytes to read
+ 
+ Return Value: uint8_t
+  - 0: success
+  - 1: Error at transaction
+ **********************************************/
+uint8_t i2c_readRegisters(uint8_t i2c_addr, uint8_t reg, uint8_t *buffer, uint8_t length){
+    i2c_transaction_t transaction = {i2c_addr, &reg, 1, buffer, length, NULL, NULL, I2C_IDLE, 0, 0};
+    return i2c_transfer(&transaction) != I2C_DONE;
+}
 #else
 #error "Micorcontroller not supported now!"
 #endif
\ No newline at end of file
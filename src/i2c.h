@@ -36,6 +36,35 @@ extern uint8_t I2C_ErrorCode;		// variable for communication error at twi
 #define I2C_BYTE		2			// bit 0: timeout byte-transmission
 #define I2C_READACK		3			// bit 0: timeout read acknowledge
 #define I2C_READNACK	4			// bit 0: timeout read nacknowledge
+#define I2C_TRANSACTION	5			// bit 0: queued transaction failed
+
+#define I2C_QUEUE_SIZE	8			// pending transactions, must be power of 2
+#define I2C_TIMEOUT		(F_CPU/F_I2C*16UL)	// polls without bus event before a blocking wait aborts
+
+typedef enum {
+	I2C_IDLE,
+	I2C_QUEUED,
+	I2C_ACTIVE,
+	I2C_DONE,
+	I2C_NACK,
+	I2C_BUSERROR
+} i2c_status_t;
+
+struct i2c_transaction;
+typedef void (*i2c_callback_t)( struct i2c_transaction *transaction );
+
+typedef struct i2c_transaction {
+	uint8_t address;				// 7 bit slave-adress without r/w-bit
+	const uint8_t *writeBuffer;		// sent first, may be NULL
+	uint8_t writeLength;
+	uint8_t *readBuffer;			// filled after (repeated) start, may be NULL
+	uint8_t readLength;
+	i2c_callback_t callback;		// called from TWI_vect when done, may be NULL
+	void *context;					// free for the owner of the transaction
+	volatile i2c_status_t status;
+	uint16_t startTime;
+	uint16_t duration;				// completion time in clock source ticks
+} i2c_transaction_t;
 
 void i2c_init( void );				// init hw-i2c
 void i2c_start( void );
@@ -47,6 +76,14 @@ void i2c_write( uint8_t byte );		// send data_byte
 uint8_t i2c_readAck( void );          // read byte with ACK
 uint8_t i2c_readNAck( void );         // read byte with NACK
 
+uint8_t i2c_enqueue( i2c_transaction_t *transaction );	// queue transaction, 1 if queue is full
+i2c_status_t i2c_transfer( i2c_transaction_t *transaction );	// queue and wait for transaction, bounded
+uint8_t i2c_queueDepth( void );       // transactions pending or on the bus
+void i2c_wait( void );                // wait until the queue is drained, bounded
+void i2c_setClockSource( uint16_t (*clock)( void ) );	// time base for duration
+
+uint8_t i2c_readRegisters( uint8_t i2c_addr, uint8_t reg, uint8_t *buffer, uint8_t length );	// write pointer, repeated start, read
+
 #ifdef __cplusplus
 }
 #endif
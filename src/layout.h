@@ -0,0 +1,112 @@
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include "clock.h"
+
+/*
+ * Output layouts resolved at compile time. A layout is a constexpr char
+ * array with strftime style directives, layout<array> unrolls it into the
+ * matching emitter calls and knows its longest output as a constant.
+ *
+ *   %Y year      %y year % 100   %m month     %d day       %a weekday name
+ *   %H hour 0-23 %I hour 1-12    %p AM/PM     %M minute    %S second
+ *   %F dateString                %T timeString             %V ISO week
+ *   %t temperature, one decimal  %q temperature, two decimals  %% percent sign
+ *
+ * Everything else is copied as is.
+ */
+
+template <const char *Layout, uint8_t Index = 0, char Code = Layout[Index]>
+struct layout_step;
+
+template <const char *Layout, uint8_t Index, char Code>
+struct layout_field
+{
+    static_assert(Code != Code, "unknown layout directive");
+};
+
+/* Literal character */
+template <const char *Layout, uint8_t Index, char Code>
+struct layout_step
+{
+    typedef layout_step<Layout, Index + 1> next;
+    static constexpr uint8_t length = 1 + next::length;
+
+    static char *emit(char *string, const clock_control_t *clockControl)
+    {
+        *string++ = Code;
+        return next::emit(string, clockControl);
+    }
+};
+
+template <const char *Layout, uint8_t Index>
+struct layout_step<Layout, Index, '\0'>
+{
+    static constexpr uint8_t length = 0;
+
+    static char *emit(char *string, const clock_control_t *)
+    {
+        return string;
+    }
+};
+
+template <const char *Layout, uint8_t Index>
+struct layout_step<Layout, Index, '%'> : layout_field<Layout, Index + 1, Layout[Index + 1]>
+{
+};
+
+/* One directive, Width is the longest text it can produce */
+#define LAYOUT_FIELD(code, width, ...)                                                     \
+    template <const char *Layout, uint8_t Index>                                          \
+    struct layout_field<Layout, Index, code>                                              \
+    {                                                                                     \
+        typedef layout_step<Layout, Index + 1> next;                                      \
+        static constexpr uint8_t length = width + next::length;                           \
+                                                                                          \
+        static char *emit(char *string, const clock_control_t *clockControl)              \
+        {                                                                                 \
+            __VA_ARGS__;                                                                  \
+            return next::emit(string, clockControl);                                      \
+        }                                                                                 \
+    };
+
+LAYOUT_FIELD('Y', 4, string = format_uint(string, clockControl->date.years.yyyy, 4))
+LAYOUT_FIELD('y', 2, string = format_uint(string, clockControl->date.years.yyyy % 100, 2))
+LAYOUT_FIELD('m', 2, string = format_uint(string, clockControl->date.months, 2))
+LAYOUT_FIELD('d', 2, string = format_uint(string, clockControl->date.days, 2))
+LAYOUT_FIELD('H', 2, string = format_uint(string, clockControl->time.hours, 2))
+LAYOUT_FIELD('I', 2, string = format_uint(string, ((clockControl->time.hours + 11) % 12) + 1, 2))
+LAYOUT_FIELD('p', 2, *string++ = (clockControl->time.hours < 12) ? 'A' : 'P'; *string++ = 'M')
+LAYOUT_FIELD('M', 2, string = format_uint(string, clockControl->time.minutes, 2))
+LAYOUT_FIELD('S', 2, string = format_uint(string, clockControl->time.seconds, 2))
+LAYOUT_FIELD('F', 10, memcpy(string, clockControl->dateString, 10); string += 10)
+LAYOUT_FIELD('T', 8, memcpy(string, clockControl->timeString, 8); string += 8)
+LAYOUT_FIELD('V', 2, string = format_uint(string, calendar_isoWeek(clockControl->date.years.yyyy, clockControl->date.months, clockControl->date.days), 2))
+LAYOUT_FIELD('a', 9, *string = '\0'; weekdayToString(clockControl->weekday, string); string += strlen(string))
+LAYOUT_FIELD('t', 6, string = format_fixed(string, clockControl->temperature, 2, 1))
+LAYOUT_FIELD('q', 7, string = format_fixed(string, clockControl->temperature, 2, 2))
+LAYOUT_FIELD('%', 1, *string++ = '%')
+
+#undef LAYOUT_FIELD
+
+template <const char *Layout>
+struct layout
+{
+    /* Longest output without and with the terminator */
+    static constexpr uint8_t length = layout_step<Layout>::length;
+    static constexpr uint8_t size = length + 1;
+
+    static char *emit(char *string, const clock_control_t *clockControl)
+    {
+        return layout_step<Layout>::emit(string, clockControl);
+    }
+
+    template <size_t N>
+    static void render(char (&buffer)[N], const clock_control_t *clockControl)
+    {
+        static_assert(N >= size, "buffer is too small for this layout");
+        *emit(buffer, clockControl) = '\0';
+    }
+};
+
+#endif /* LAYOUT_H_ */
@@ -1,21 +1,79 @@
+#include <avr/sleep.h>
+
 #include "clock.h"
+#include "alarm.h"
+#include "timebase.h"
+#include "clocksync.h"
+#include "calibration.h"
+#include "temperature.h"
+#include "layout.h"
 
 static DS3231_buffer_t rtcBuffer;
 DS3231_buffer_t *p_rtcBuffer = &rtcBuffer;
-static clock_control_t clockControl = {STOP, {0, 0, 0}, {{2000}, 1, 1}, SATURDAY, DAYS_PER_MONTH_MAX, "00:00:00", "2000-01-01", 25.0};
+static clock_control_t clockControl = {STOP, {0, 0, 0}, {{2000}, 1, 1}, SATURDAY, DAYS_PER_MONTH_MAX, 1, true, "00:00:00", "2000-01-01", 25 * 4};
 clock_control_t *p_clockCtrl = &clockControl;
+static clock_control_t clockView;
 static settings_control_t settingsControl = {0, 0, 0, NOT_PRESSED, NOT_PRESSED, NO_UNIT, SECONDS, 0};
 settings_control_t *p_settingsCtrl = &settingsControl;
+static clock_sync_t clockSync;
+clock_sync_t *p_clockSync = &clockSync;
+
+static heartbeat_stats_t heartbeatStats;
+heartbeat_stats_t *p_heartbeatStats = &heartbeatStats;
 
-volatile bool g_heartbeat_1s = false;
-/* Increases every second (from RTC) */
-volatile static uint32_t g_secondsCounter = 0;
-/* Increases every 1/1024 of a second, close to 1ms */
-volatile static uint32_t g_msCounter = 0;
+/* Seconds not yet handled by the main loop, a slow loop lets several pile up */
+volatile uint8_t g_pendingTicks = 0;
 
-char g_stringBuffer[30] = "I'm alive\n";
+static constexpr char telemetryLayout[] = CLOCK_DATE_LAYOUT "\n" CLOCK_TIME_LAYOUT "\n%t°C\n";
+char g_telemetryString[layout<telemetryLayout>::size];
 uint8_t g_ledBuffer[7] = {0, 0, 0, 0, 0, 0, 4};
 
+/* Called from interrupt context once per RTC second */
+static void secondElapsed()
+{
+  if (g_pendingTicks < UINT8_MAX)
+  {
+    g_pendingTicks++;
+  }
+  if (p_clockCtrl->clockState == RUNNING)
+  {
+    clock_tick(p_clockCtrl);
+  }
+}
+
+#if defined(AGING_CALIBRATION) && defined(_USART_DEBUG)
+/* Reference timestamps arrive as "T<seconds>" lines */
+static void readReferenceStream()
+{
+  static uint32_t value = 0;
+  static bool inTimestamp = false;
+  uint16_t c;
+
+  while (!((c = uart_getc()) & UART_NO_DATA))
+  {
+    c &= 0xFF;
+    if (c == 'T')
+    {
+      value = 0;
+      inTimestamp = true;
+    }
+    else if (inTimestamp && (c >= '0') && (c <= '9'))
+    {
+      value = (value * 10) + (c - '0');
+    }
+    else if (inTimestamp && ((c == '\n') || (c == '\r')))
+    {
+      calibration_timestamp(value);
+      inTimestamp = false;
+    }
+    else
+    {
+      inTimestamp = false;
+    }
+  }
+}
+#endif /* AGING_CALIBRATION && _USART_DEBUG */
+
 int main(void)
 {
   if (init() == 1)
@@ -36,51 +94,155 @@ int main(void)
 
   while (1)
   {
-    // When a 1hz interrupt is triggered
-    if (g_heartbeat_1s)
+    // Take every tick since the last pass, the clock itself was already advanced by the ISR
+    uint8_t pendingTicks;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
     {
-      // Release and prepare next second trigger
-      g_heartbeat_1s = false;
+      pendingTicks = g_pendingTicks;
+      g_pendingTicks = 0;
+    }
+
+    if (pendingTicks > 0)
+    {
+      uint32_t loopStart = timebase_millis();
+
+      // Missed seconds are handled in one batch, only the latest second is rendered
+      if (pendingTicks > 1)
+      {
+        p_heartbeatStats->overruns++;
+        p_heartbeatStats->missedTicks += pendingTicks - 1;
+      }
+      if (pendingTicks > p_heartbeatStats->worstBacklog)
+      {
+        p_heartbeatStats->worstBacklog = pendingTicks;
+      }
+      DS3231_cacheTick();
 
-      // First time sync with RTC
-      if (p_clockCtrl->clockState == STANDBY)
+      // First time sync with RTC, then whenever the drift estimate asks for it
+      if ((p_clockCtrl->clockState == STANDBY) || clocksync_due(p_clockSync))
       {
-        DS3231_getAll(p_rtcBuffer);
-
-        syncControl(DS3231_SECONDS, p_rtcBuffer, p_clockCtrl);
-        syncControl(DS3231_MINUTES, p_rtcBuffer, p_clockCtrl);
-        syncControl(DS3231_HOURS, p_rtcBuffer, p_clockCtrl);
-        syncControl(DS3231_DATE, p_rtcBuffer, p_clockCtrl);
-        syncControl(DS3231_MONTH, p_rtcBuffer, p_clockCtrl);
-        syncControl(DS3231_YEAR, p_rtcBuffer, p_clockCtrl);
-        p_clockCtrl->weekday = getWeekday(&p_clockCtrl->date);
-        p_clockCtrl->temperature = DS3231_getTemp();
-        p_clockCtrl->clockState = RUNNING; 
+        if (clocksync_update(p_clockSync, p_clockCtrl))
+        {
+          // The nearest alarm is chosen against the software clock, which just moved
+          alarm_reload();
+
+#ifdef _USART_DEBUG
+          uart_puts_P("sync ");
+          format_putInt(uart0_puts, p_clockSync->offset, 0);
+          uart_puts_P(" s ");
+          format_putInt(uart0_puts, p_clockSync->drift, 0);
+          uart_puts_P(" ppm ");
+          format_putUint(uart0_puts, p_clockSync->interval, 0);
+          uart_puts_P(" s\n");
+#endif /* _USART_DEBUG */
+        }
+#ifdef _USART_DEBUG
+        else
+        {
+          uart_puts_P("sync failed\n");
+        }
+#endif /* _USART_DEBUG */
+      }
 
+      // Served from the cache, the bus is only read once per conversion, scheduled on the
+      // software clock since the timebase stands still between alarm wakeups
+      clock_snapshot(p_clockCtrl, &clockView);
+      temperature_service(epoch_fromClock(&clockView));
+      if (temperature_get()->valid)
+      {
+        // Main loop writer of the seqlocked clock, the tick is held off meanwhile
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+          p_clockCtrl->temperature = temperature_get()->value;
+        }
       }
 
-      // Sync up every minute (?)
-      else if (p_clockCtrl->time.seconds == 0)
+      // Alarm flags are polled every second, or cleared after a wakeup
+      alarm_service();
+
+#ifdef AGING_CALIBRATION
+      // Log the convergence history, one record per window
+      if (calibration_service())
       {
-        p_clockCtrl->temperature = DS3231_getTemp();
-        update_clock(p_clockCtrl, MINUTES, PLUS, true, false);
+#ifdef _USART_DEBUG
+        const calibration_record_t *p_record = calibration_last();
+        uart_puts_P("aging ");
+        format_putInt(uart0_puts, p_record->aging, 0);
+        uart_puts_P(" after ");
+        format_putUint(uart0_puts, p_record->referenceSeconds, 0);
+        uart_puts_P(" s, ");
+        format_putInt(uart0_puts, p_record->error, 0);
+        uart_puts_P(" cppm");
+        if (calibration_status()->converged)
+        {
+          uart_puts_P(", converged");
+        }
+        uart_putc('\n');
+#endif /* _USART_DEBUG */
       }
+#endif /* AGING_CALIBRATION */
 
-      DS3231_setByte(DS3231_MONTH, 0x07);
-      DS3231_setByte(DS3231_DATE, 0x10);
-      timeToBCD(p_clockCtrl->time, g_ledBuffer);
-      if (p_clockCtrl->clockState == RUNNING)
+      // Render from a snapshot, the next tick may land while drawing
+      clock_snapshot(p_clockCtrl, &clockView);
+#ifdef CLOCK_BCD_CORE
+      packedToBCD(clockView.bcdTime, g_ledBuffer);
+#else
+      timeToBCD(clockView.time, g_ledBuffer);
+#endif /* CLOCK_BCD_CORE */
+      if (clockView.clockState == RUNNING)
       {
         clockToLED(g_ledBuffer);
-        clockToOLED(p_clockCtrl);
+        clockToOLED(&clockView);
       }
-      sprintf(g_stringBuffer, "%04d-%02d-%02d\n%02d:%02d:%02d\n%.1f°C\n", p_clockCtrl->date.years.yyyy, p_clockCtrl->date.months, p_clockCtrl->date.days, p_clockCtrl->time.hours, p_clockCtrl->time.minutes, p_clockCtrl->time.seconds, p_clockCtrl->temperature);
-      uart_puts(g_stringBuffer);
+      layout<telemetryLayout>::render(g_telemetryString, &clockView);
+      uart_puts(g_telemetryString);
 
 #ifdef _USART_DEBUG
       // printTime();
 #endif /* IFDEF _USART_DEBUG */
+
+      uint32_t loopTime = timebase_millis() - loopStart;
+      if (loopTime > p_heartbeatStats->longestLoop)
+      {
+        p_heartbeatStats->longestLoop = (loopTime > UINT16_MAX) ? UINT16_MAX : loopTime;
+#ifdef _USART_DEBUG
+        uart_puts_P("loop ");
+        format_putUint(uart0_puts, p_heartbeatStats->longestLoop, 0);
+        uart_puts_P(" ms, ");
+        format_putUint(uart0_puts, p_heartbeatStats->overruns, 0);
+        uart_puts_P(" overruns, backlog ");
+        format_putUint(uart0_puts, p_heartbeatStats->worstBacklog, 0);
+        uart_putc('\n');
+#endif /* _USART_DEBUG */
+      }
+
+#ifdef ALARM_WAKEUP
+      EIMSK = _BV(INT0);
+#endif /* ALARM_WAKEUP */
+    }
+
+#if defined(AGING_CALIBRATION) && defined(_USART_DEBUG)
+    readReferenceStream();
+#endif /* AGING_CALIBRATION && _USART_DEBUG */
+
+#ifdef ALARM_WAKEUP
+    /* Sleep until the next alarm, the TWI queue must be drained first */
+    i2c_wait();
+#ifdef _USART_DEBUG
+    set_sleep_mode(SLEEP_MODE_IDLE);
+#else
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+#endif /* _USART_DEBUG */
+    cli();
+    if (g_pendingTicks == 0)
+    {
+      sleep_enable();
+      sei();
+      sleep_cpu();
+      sleep_disable();
     }
+    sei();
+#endif /* ALARM_WAKEUP */
   }
 }
 
@@ -90,8 +252,10 @@ uint8_t init()
   DDRD &= _BV(PORTD2);
   EICRA = (_BV(ISC01) | _BV(ISC00));
 
-  /* Enable INT0 external interrupt */
+#if (TIMEBASE_HZ == 1) || defined(ALARM_WAKEUP)
+  /* Enable INT0 external interrupt, kHz modes derive the heartbeat from Timer1 */
   EIMSK = _BV(INT0);
+#endif
 
 #ifdef _USART_DEBUG
   uart_init(UART_BAUD_SELECT(UART_BAUD_RATE, F_CPU));
@@ -120,6 +284,27 @@ uint8_t init()
     _rtc_tryCounter++;
   }
 
+  timebase_init(TIMEBASE_MODE, secondElapsed);
+  i2c_setClockSource(timebase_ticks16);
+  clocksync_init(p_clockSync, CLOCKSYNC_ERROR_BOUND);
+  temperature_init();
+
+  /* First sync before the alarms are armed, a failed read is retried from the main loop */
+  p_clockCtrl->clockState = STANDBY;
+  clocksync_update(p_clockSync, p_clockCtrl);
+
+#ifdef AGING_CALIBRATION
+  calibration_start();
+#endif /* AGING_CALIBRATION */
+
+#ifdef ALARM_WAKEUP
+  /* INT is held low by the RTC until the alarm flags are cleared, low level also wakes from power down */
+  EICRA = 0x00;
+  alarm_init(p_clockCtrl, true);
+#else
+  alarm_init(p_clockCtrl, false);
+#endif /* ALARM_WAKEUP */
+
   sei();
 
 #ifdef _USART_DEBUG
@@ -129,17 +314,28 @@ uint8_t init()
   oled_clrscr();
   oled_puts_p(PSTR("Init complete"));
 
-  p_clockCtrl->clockState = STANDBY;
+#ifdef ALARM_WAKEUP
+  /* Render right away instead of waiting up to a minute for the first A2 match */
+  g_pendingTicks = 1;
+#endif /* ALARM_WAKEUP */
 
   return 0;
 }
 
 ISR(INT0_vect)
 {
-  g_heartbeat_1s = true;
-  g_secondsCounter++;
+#ifdef ALARM_WAKEUP
+  /* INT stays low until the flags are cleared, resync from the RTC on every wakeup */
+  EIMSK &= ~_BV(INT0);
+  if (g_pendingTicks < UINT8_MAX)
+  {
+    g_pendingTicks++;
+  }
   if (p_clockCtrl->clockState == RUNNING)
   {
-    tickSeconds(p_clockCtrl);
+    p_clockCtrl->clockState = STANDBY;
   }
+#else
+  timebase_secondEdge();
+#endif /* ALARM_WAKEUP */
 }
@@ -58,9 +58,14 @@ static struct {
 } cursorPosition;
 
 static uint8_t charMode = NORMALSIZE;
-#if defined GRAPHICMODE
 #include <stdlib.h>
+#if defined GRAPHICMODE
 static uint8_t displayBuffer[DISPLAY_HEIGHT/8][DISPLAY_WIDTH];
+// columns changed since the last transfer, per page, clean if first > last
+static struct {
+    uint8_t first;
+    uint8_t last;
+} dirtySpan[DISPLAY_HEIGHT/8];
 #elif defined TEXTMODE
 #else
 #error "No valid displaymode! Refer lcd.h"
@@ -118,24 +123,50 @@ void oled_command(uint8_t cmd[], uint8_t size) {
     LCD_PORT |= (1 << CS_PIN);
 #endif
 }
-void oled_data(uint8_t data[], uint16_t size) {
+// open data transfer, any number of bytes can follow before it is closed
+static void oled_data_start(void) {
 #if defined I2C
     i2c_start_sla((LCD_I2C_ADR << 1) | 0);
     i2c_write(0x40);    // 0x00 for command, 0x40 for data
-    for (uint16_t i = 0; i<size; i++) {
-        i2c_write(data[i]);
-    }
-    i2c_stop();
 #elif defined SPI
 	LCD_PORT &= ~(1 << CS_PIN);
 	LCD_PORT |= (1 << DC_PIN);
-	for (uint16_t i = 0; i<size; i++) {
-        SPDR = data[i];
-        while(!(SPSR & (1<<SPIF)));
-    }
+#endif
+}
+static void oled_data_byte(uint8_t data) {
+#if defined I2C
+    i2c_write(data);
+#elif defined SPI
+    SPDR = data;
+    while(!(SPSR & (1<<SPIF)));
+#endif
+}
+static void oled_data_stop(void) {
+#if defined I2C
+    i2c_stop();
+#elif defined SPI
     LCD_PORT |= (1 << CS_PIN);
 #endif
 }
+void oled_data(uint8_t data[], uint16_t size) {
+    oled_data_start();
+    for (uint16_t i = 0; i<size; i++) {
+        oled_data_byte(data[i]);
+    }
+    oled_data_stop();
+}
+#if defined GRAPHICMODE
+static void oled_mark_dirty(uint8_t line, uint8_t first, uint8_t last) {
+    if (first < dirtySpan[line].first) dirtySpan[line].first = first;
+    if (last > dirtySpan[line].last) dirtySpan[line].last = last;
+}
+static void oled_mark_clean(void) {
+    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
+        dirtySpan[i].first = DISPLAY_WIDTH;
+        dirtySpan[i].last = 0;
+    }
+}
+#endif
 #pragma mark -
 #pragma mark GENERAL FUNCTIONS
 void oled_init(uint8_t dispAttr){
@@ -181,12 +212,16 @@ void oled_clrscr(void){
         oled_gotoxy(0,i);
         oled_data(displayBuffer[i], sizeof(displayBuffer[i]));
     }
+    oled_mark_clean();
 #elif defined TEXTMODE
-    uint8_t displayBuffer[DISPLAY_WIDTH];
-    memset(displayBuffer, 0x00, sizeof(displayBuffer));
     for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
         oled_gotoxy(0,i);
-        oled_data(displayBuffer, sizeof(displayBuffer));
+        // stream the blank line, no buffer needed
+        oled_data_start();
+        for (uint8_t j = 0; j < DISPLAY_WIDTH; j++) {
+            oled_data_byte(0x00);
+        }
+        oled_data_stop();
     }
 #endif
     oled_home();
@@ -216,6 +251,22 @@ void oled_set_contrast(uint8_t contrast){
     uint8_t commandSequence[2] = {0x81, contrast};
     oled_command(commandSequence, sizeof(commandSequence));
 }
+// font index of a printable char, 0xff if there is no glyph for it
+static uint8_t oled_glyph(char c){
+    if (c < ' ') return 0xff;
+    c -= ' ';
+    if (c >= pgm_read_byte(&special_char[0][1]) ) {
+        char temp = c;
+        c = 0xff;
+        for (uint8_t i=0; pgm_read_byte(&special_char[i][1]) != 0xff; i++) {
+            if ( pgm_read_byte(&special_char[i][0])-' ' == temp ) {
+                c = pgm_read_byte(&special_char[i][1]);
+                break;
+            }
+        }
+    }
+    return (uint8_t)c;
+}
 void oled_putc(char c){
     switch (c) {
         case '\b':
@@ -246,18 +297,8 @@ void oled_putc(char c){
             // char doesn't fit in line
             if( (cursorPosition.x >= DISPLAY_WIDTH-sizeof(FONT[0])) || (c < ' ') ) break;
             // mapping char
-            c -= ' ';
-            if (c >= pgm_read_byte(&special_char[0][1]) ) {
-                char temp = c;
-                c = 0xff;
-                for (uint8_t i=0; pgm_read_byte(&special_char[i][1]) != 0xff; i++) {
-                    if ( pgm_read_byte(&special_char[i][0])-' ' == temp ) {
-                        c = pgm_read_byte(&special_char[i][1]);
-                        break;
-                    }
-                }
-                if ( c == 0xff ) break;
-            }
+            c = oled_glyph(c);
+            if ( (uint8_t)c == 0xff ) break;
             // print char at display
 #ifdef GRAPHICMODE
             if (charMode == DOUBLESIZE) {
@@ -283,6 +324,10 @@ void oled_putc(char c){
                     displayBuffer[cursorPosition.y][cursorPosition.x+(2*i)] = doubleChar[i] & 0xff;
                     displayBuffer[cursorPosition.y][cursorPosition.x+(2*i)+1] = doubleChar[i] & 0xff;
                 }
+                oled_mark_dirty(cursorPosition.y, cursorPosition.x, cursorPosition.x+2*sizeof(FONT[0])-1);
+                if (cursorPosition.y+1 < DISPLAY_HEIGHT/8) {
+                    oled_mark_dirty(cursorPosition.y+1, cursorPosition.x, cursorPosition.x+2*sizeof(FONT[0])-1);
+                }
                 cursorPosition.x += sizeof(FONT[0])*2;
             } else {
             	if ((cursorPosition.x+sizeof(FONT[0]))>DISPLAY_WIDTH) break;
@@ -292,6 +337,7 @@ void oled_putc(char c){
                     // load bit-pattern from flash
                     displayBuffer[cursorPosition.y][cursorPosition.x+i] =pgm_read_byte(&(FONT[(uint8_t)c][i]));
                 }
+                oled_mark_dirty(cursorPosition.y, cursorPosition.x, cursorPosition.x+sizeof(FONT[0])-1);
                 cursorPosition.x += sizeof(FONT[0]);
             }
 #elif defined TEXTMODE
@@ -399,6 +445,40 @@ void oled_flip(uint8_t flipping){
 			break;
 	}
 }
+#if defined TEXTMODE
+// print a string from ram or flash, every run of printable chars is a single
+// data transfer with the glyph columns streamed from flash
+static void oled_puts_run(const char* s, uint8_t progmem){
+    char c;
+    while ((c = progmem ? pgm_read_byte(s) : *s)) {
+        // control chars, unprintable chars and double size go through oled_putc
+        if ((c < ' ') || (charMode != NORMALSIZE)) {
+            oled_putc(c);
+            s++;
+            continue;
+        }
+        oled_data_start();
+        while ((c = progmem ? pgm_read_byte(s) : *s) >= ' ') {
+            s++;
+            // same clipping as oled_putc
+            if (cursorPosition.x >= DISPLAY_WIDTH-sizeof(FONT[0])) continue;
+            uint8_t glyph = oled_glyph(c);
+            if (glyph == 0xff) continue;
+            for (uint8_t i = 0; i < sizeof(FONT[0]); i++) {
+                oled_data_byte(pgm_read_byte(&(FONT[glyph][i])));
+            }
+            cursorPosition.x += sizeof(FONT[0]);
+        }
+        oled_data_stop();
+    }
+}
+void oled_puts(const char* s){
+    oled_puts_run(s, 0);
+}
+void oled_puts_p(const char* progmem_s){
+    oled_puts_run(progmem_s, 1);
+}
+#else
 void oled_puts(const char* s){
     while (*s) {
         oled_putc(*s++);
@@ -410,6 +490,208 @@ void oled_puts_p(const char* progmem_s){
         oled_putc(c);
     }
 }
+#endif
+#pragma mark -
+#pragma mark BANDED GRAPHICS
+// every band_ function draws only the part that falls into page line of the frame
+static void band_pixel(uint8_t band[], uint8_t line, int16_t x, int16_t y, uint8_t color){
+    if (x < 0 || x > DISPLAY_WIDTH-1 || y < 0 || (y >> 3) != line) return;
+    if (color == WHITE) {
+        band[x] |= (1 << (y & 7));
+    } else {
+        band[x] &= ~(1 << (y & 7));
+    }
+}
+static void band_fill(uint8_t band[], uint8_t line, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color){
+    int16_t top = line << 3;
+    if (x1 > x2) { int16_t temp = x1; x1 = x2; x2 = temp; }
+    if (y1 > y2) { int16_t temp = y1; y1 = y2; y2 = temp; }
+    if (y2 < top || y1 > top+7 || x2 < 0 || x1 > DISPLAY_WIDTH-1) return;
+    if (y1 < top) y1 = top;
+    if (y2 > top+7) y2 = top+7;
+    if (x1 < 0) x1 = 0;
+    if (x2 > DISPLAY_WIDTH-1) x2 = DISPLAY_WIDTH-1;
+    // all rows of the span in one mask, one read-modify-write per column
+    uint8_t mask = (uint8_t)(0xFF << (y1 - top)) & (uint8_t)(0xFF >> (top+7 - y2));
+    for (int16_t x = x1; x <= x2; x++) {
+        if (color == WHITE) {
+            band[x] |= mask;
+        } else {
+            band[x] &= ~mask;
+        }
+    }
+}
+static void band_line(uint8_t band[], uint8_t line, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color){
+    int16_t top = line << 3;
+    if ((y1 < top && y2 < top) || (y1 > top+7 && y2 > top+7)) return;
+    
+    int16_t dx =  abs(x2-x1), sx = x1<x2 ? 1 : -1;
+    int16_t dy = -abs(y2-y1), sy = y1<y2 ? 1 : -1;
+    int16_t err = dx+dy, e2; /* error value e_xy */
+    
+    while(1){
+        band_pixel(band, line, x1, y1, color);
+        if (x1==x2 && y1==y2) break;
+        e2 = 2*err;
+        if (e2 > dy) { err += dy; x1 += sx; } /* e_xy+e_x > 0 */
+        if (e2 < dx) { err += dx; y1 += sy; } /* e_xy+e_y < 0 */
+    }
+}
+// vertical spans of a filled circle between the mirrored octant points of the
+// midpoint walk, every column is handed out once or twice
+typedef void (*circle_span_t)(int16_t x, int16_t y1, int16_t y2, void *context);
+static void circle_spans(int16_t center_x, int16_t center_y, int16_t radius, circle_span_t span, void *context){
+    int16_t f = 1 - radius;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * radius;
+    int16_t x = 0;
+    int16_t y = radius;
+    
+    span(center_x, center_y-radius, center_y+radius, context);
+    while (x<y) {
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        
+        span(center_x + x, center_y - y, center_y + y, context);
+        span(center_x - x, center_y - y, center_y + y, context);
+        span(center_x + y, center_y - x, center_y + x, context);
+        span(center_x - y, center_y - x, center_y + x, context);
+    }
+}
+typedef struct {
+    uint8_t *band;
+    uint8_t line;
+    uint8_t color;
+} band_target_t;
+static void band_span(int16_t x, int16_t y1, int16_t y2, void *context){
+    band_target_t *target = (band_target_t *)context;
+    band_fill(target->band, target->line, x, y1, x, y2, target->color);
+}
+static void band_circle(uint8_t band[], uint8_t line, int16_t center_x, int16_t center_y, int16_t radius, uint8_t color, uint8_t fill){
+    int16_t top = line << 3;
+    if (center_y+radius < top || center_y-radius > top+7) return;
+    
+    if (fill) {
+        band_target_t target = {band, line, color};
+        circle_spans(center_x, center_y, radius, band_span, &target);
+        return;
+    }
+    
+    int16_t f = 1 - radius;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * radius;
+    int16_t x = 0;
+    int16_t y = radius;
+    
+    band_pixel(band, line, center_x  , center_y+radius, color);
+    band_pixel(band, line, center_x  , center_y-radius, color);
+    band_pixel(band, line, center_x+radius, center_y  , color);
+    band_pixel(band, line, center_x-radius, center_y  , color);
+    
+    while (x<y) {
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        
+        band_pixel(band, line, center_x + x, center_y + y, color);
+        band_pixel(band, line, center_x - x, center_y + y, color);
+        band_pixel(band, line, center_x + x, center_y - y, color);
+        band_pixel(band, line, center_x - x, center_y - y, color);
+        band_pixel(band, line, center_x + y, center_y + x, color);
+        band_pixel(band, line, center_x - y, center_y + x, color);
+        band_pixel(band, line, center_x + y, center_y - x, color);
+        band_pixel(band, line, center_x - y, center_y - x, color);
+    }
+}
+static void band_bitmap(uint8_t band[], uint8_t line, uint8_t x, uint8_t y, const uint8_t *picture, uint8_t width, uint8_t height, uint8_t color){
+    uint8_t byteWidth = (width+7)/8;
+    int16_t top = line << 3;
+    for (int16_t j = 0; j < height; j++) {
+        if (y+j < top) continue;
+        if (y+j > top+7) break;
+        for (uint8_t i = 0; i < width; i++) {
+            if (pgm_read_byte(picture + j * byteWidth + i / 8) & (128 >> (i & 7))) {
+                band_pixel(band, line, x+i, y+j, color);
+            } else {
+                band_pixel(band, line, x+i, y+j, !color);
+            }
+        }
+    }
+}
+static void band_text(uint8_t band[], uint8_t line, int16_t x, uint8_t y, const char *s, uint8_t progmem, uint8_t color){
+    int16_t shift = y - (line << 3);
+    if (shift <= -8 || shift >= 8) return;
+    char c;
+    // same clipping as oled_putc
+    while ((c = progmem ? pgm_read_byte(s) : *s) && x < (int16_t)(DISPLAY_WIDTH-sizeof(FONT[0]))) {
+        s++;
+        uint8_t glyph = oled_glyph(c);
+        if (glyph == 0xff) continue;
+        // glyph cells are one page high and opaque like oled_putc, BLACK inverts them,
+        // a text line between pages lands in two bands
+        for (uint8_t i = 0; i < sizeof(FONT[0]); i++) {
+            uint8_t column = pgm_read_byte(&(FONT[glyph][i]));
+            if (color != WHITE) column = ~column;
+            uint8_t cell = (shift >= 0) ? (0xFF << shift) : (0xFF >> -shift);
+            column = (shift >= 0) ? (column << shift) : (column >> -shift);
+            band[x+i] = (band[x+i] & ~cell) | column;
+        }
+        x += sizeof(FONT[0]);
+    }
+}
+void oled_render(const oled_item_t list[], uint8_t count){
+    uint8_t band[DISPLAY_WIDTH];
+    
+    for (uint8_t line = 0; line < DISPLAY_HEIGHT/8; line++){
+        memset(band, 0x00, sizeof(band));
+        for (uint8_t i = 0; i < count; i++){
+            const oled_item_t *item = &list[i];
+            switch (item->type) {
+                case OLED_ITEM_PIXEL:
+                    band_pixel(band, line, item->x1, item->y1, item->color);
+                    break;
+                case OLED_ITEM_LINE:
+                    band_line(band, line, item->x1, item->y1, item->x2, item->y2, item->color);
+                    break;
+                case OLED_ITEM_RECT:
+                    band_fill(band, line, item->x1, item->y1, item->x2, item->y1, item->color);
+                    band_fill(band, line, item->x1, item->y2, item->x2, item->y2, item->color);
+                    band_fill(band, line, item->x1, item->y1, item->x1, item->y2, item->color);
+                    band_fill(band, line, item->x2, item->y1, item->x2, item->y2, item->color);
+                    break;
+                case OLED_ITEM_FILLRECT:
+                    band_fill(band, line, item->x1, item->y1, item->x2, item->y2, item->color);
+                    break;
+                case OLED_ITEM_CIRCLE:
+                case OLED_ITEM_FILLCIRCLE:
+                    band_circle(band, line, item->x1, item->y1, item->x2, item->color, item->type == OLED_ITEM_FILLCIRCLE);
+                    break;
+                case OLED_ITEM_BITMAP:
+                    band_bitmap(band, line, item->x1, item->y1, (const uint8_t *)item->data, item->x2, item->y2, item->color);
+                    break;
+                case OLED_ITEM_TEXT:
+                case OLED_ITEM_TEXT_P:
+                    band_text(band, line, item->x1, item->y1, (const char *)item->data, item->type == OLED_ITEM_TEXT_P, item->color);
+                    break;
+                default:
+                    break;
+            }
+        }
+        oled_goto_xpix_y(0, line);
+        oled_data(band, sizeof(band));
+    }
+}
 #ifdef GRAPHICMODE
 #pragma mark -
 #pragma mark GRAPHIC FUNCTIONS
@@ -421,18 +703,42 @@ uint8_t oled_drawPixel(uint8_t x, uint8_t y, uint8_t color){
     } else {
         displayBuffer[(y / 8)][x] &= ~(1 << (y % 8));
     }
+    oled_mark_dirty(y / 8, x, x);
     
     return 0;
 }
+// rectangle of pixels, one masked byte per column and page instead of one call per pixel
+static void oled_fill_span(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color){
+    if (x1 > x2) { int16_t temp = x1; x1 = x2; x2 = temp; }
+    if (y1 > y2) { int16_t temp = y1; y1 = y2; y2 = temp; }
+    if (x2 < 0 || x1 > DISPLAY_WIDTH-1 || y2 < 0 || y1 > DISPLAY_HEIGHT-1) return;
+    if (x1 < 0) x1 = 0;
+    if (x2 > DISPLAY_WIDTH-1) x2 = DISPLAY_WIDTH-1;
+    if (y1 < 0) y1 = 0;
+    if (y2 > DISPLAY_HEIGHT-1) y2 = DISPLAY_HEIGHT-1;
+    for (uint8_t line = y1 >> 3; line <= (y2 >> 3); line++){
+        band_fill(displayBuffer[line], line, x1, y1, x2, y2, color);
+        oled_mark_dirty(line, x1, x2);
+    }
+}
 uint8_t oled_drawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color){
 	uint8_t result;
 	
+    // a line is off the display wherever one of its ends is
+    result = (x1 > DISPLAY_WIDTH-1 || x2 > DISPLAY_WIDTH-1 || y1 > DISPLAY_HEIGHT-1 || y2 > DISPLAY_HEIGHT-1);
+    
+    // horizontal and vertical lines are spans
+    if (x1 == x2 || y1 == y2) {
+        oled_fill_span(x1, y1, x2, y2, color);
+        return result;
+    }
+    
     int dx =  abs(x2-x1), sx = x1<x2 ? 1 : -1;
     int dy = -abs(y2-y1), sy = y1<y2 ? 1 : -1;
     int err = dx+dy, e2; /* error value e_xy */
     
     while(1){
-        result = oled_drawPixel(x1, y1, color);
+        oled_drawPixel(x1, y1, color);
         if (x1==x2 && y1==y2) break;
         e2 = 2*err;
         if (e2 > dy) { err += dy; x1 += sx; } /* e_xy+e_x > 0 */
@@ -452,21 +758,8 @@ uint8_t oled_drawRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_
     return result;
 }
 uint8_t oled_fillRect(uint8_t px1, uint8_t py1, uint8_t px2, uint8_t py2, uint8_t color){
-    uint8_t result;
-    
-    if( px1 > px2){
-        uint8_t temp = px1;
-        px1 = px2;
-        px2 = temp;
-        temp = py1;
-        py1 = py2;
-        py2 = temp;
-    }
-    for (uint8_t i=0; i<=(py2-py1); i++){
-        result = oled_drawLine(px1, py1+i, px2, py1+i, color);
-    }
-    
-    return result;
+    oled_fill_span(px1, py1, px2, py2, color);
+    return (px1 > DISPLAY_WIDTH-1 || px2 > DISPLAY_WIDTH-1 || py1 > DISPLAY_HEIGHT-1 || py2 > DISPLAY_HEIGHT-1);
 }
 uint8_t oled_drawCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color){
     uint8_t result;
@@ -503,12 +796,12 @@ uint8_t oled_drawCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint
     }
     return result;
 }
+static void buffer_span(int16_t x, int16_t y1, int16_t y2, void *context){
+    oled_fill_span(x, y1, x, y2, *(uint8_t *)context);
+}
 uint8_t oled_fillCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color) {
-    uint8_t result;
-    for(uint8_t i=0; i<= radius;i++){
-        result = oled_drawCircle(center_x, center_y, i, color);
-    }
-    return result;
+    circle_spans(center_x, center_y, radius, buffer_span, &color);
+    return (center_x < radius || center_y < radius || center_x+radius > DISPLAY_WIDTH-1 || center_y+radius > DISPLAY_HEIGHT-1);
 }
 uint8_t oled_drawBitmap(uint8_t x, uint8_t y, const uint8_t *picture, uint8_t width, uint8_t height, uint8_t color){
     uint8_t result,i,j, byteWidth = (width+7)/8;
@@ -533,10 +826,21 @@ void oled_display() {
         oled_data(displayBuffer[i], sizeof(displayBuffer[i]));
     }
 #endif
+    oled_mark_clean();
+}
+void oled_flush() {
+    // one cursor command and one data transfer per page that changed
+    for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
+        if (dirtySpan[i].first > dirtySpan[i].last) continue;
+        oled_display_block(dirtySpan[i].first, i, dirtySpan[i].last - dirtySpan[i].first + 1);
+        dirtySpan[i].first = DISPLAY_WIDTH;
+        dirtySpan[i].last = 0;
+    }
 }
 void oled_clear_buffer() {
     for (uint8_t i = 0; i < DISPLAY_HEIGHT/8; i++){
         memset(displayBuffer[i], 0x00, sizeof(displayBuffer[i]));
+        oled_mark_dirty(i, 0, DISPLAY_WIDTH-1);
     }
 }
 uint8_t oled_check_buffer(uint8_t x, uint8_t y) {
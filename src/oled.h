@@ -134,6 +134,28 @@ extern "C" {
     						// == 1: flip horizontal & vertical
     						// == 2: flip(mirrored) vertical
     						// == 3: flip(mirrored) horizontal
+    // banded graphics: the frame is a display list, rasterized page by page into one
+    // DISPLAY_WIDTH byte band on the stack, so it works without the GRAPHICMODE buffer
+    enum {
+        OLED_ITEM_PIXEL,        // x1, y1
+        OLED_ITEM_LINE,         // x1, y1 to x2, y2
+        OLED_ITEM_RECT,         // corners x1, y1 and x2, y2
+        OLED_ITEM_FILLRECT,     // corners x1, y1 and x2, y2
+        OLED_ITEM_CIRCLE,       // centre x1, y1, radius x2
+        OLED_ITEM_FILLCIRCLE,   // centre x1, y1, radius x2
+        OLED_ITEM_BITMAP,       // top left x1, y1, size x2 * y2, data in flash (oled_drawBitmap format)
+        OLED_ITEM_TEXT,         // top left x1, y1 in pixels, data in ram
+        OLED_ITEM_TEXT_P        // top left x1, y1 in pixels, data in flash
+    };
+    typedef struct {
+        uint8_t type;
+        uint8_t color;
+        uint8_t x1, y1;
+        uint8_t x2, y2;
+        const void *data;
+    } oled_item_t;
+    void oled_render(const oled_item_t list[], uint8_t count); // rasterize and send a whole frame
+    
 #if defined GRAPHICMODE
     uint8_t oled_drawPixel(uint8_t x, uint8_t y, uint8_t color);
     uint8_t oled_drawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color);
@@ -143,6 +165,7 @@ extern "C" {
     uint8_t oled_fillCircle(uint8_t center_x, uint8_t center_y, uint8_t radius, uint8_t color);
     uint8_t oled_drawBitmap(uint8_t x, uint8_t y, const uint8_t picture[], uint8_t width, uint8_t height, uint8_t color);
     void oled_display(void);                	// copy buffer to display RAM
+    void oled_flush(void);                  	// copy only the changed columns of the buffer to display RAM
     void oled_clear_buffer(void); 		// clear display buffer
     uint8_t oled_check_buffer(uint8_t x, uint8_t y); // read a pixel value from the display buffer
     void oled_display_block(uint8_t x, uint8_t line, uint8_t width); // display (part of) a display line
@@ -0,0 +1,98 @@
+#include "temperature.h"
+
+static temperature_t temperature;
+static epoch_t lastService = 0;
+static epoch_t nextPoll = 0;
+
+/* CONTROL, STATUS, AGING, TEMP_MSB, TEMP_LSB in one read */
+static uint8_t windowStart = DS3231_CONTROL;
+static uint8_t window[DS3231_TEMP_lSB - DS3231_CONTROL + 1];
+static i2c_transaction_t readTransaction = {DS3231_ADDRESS, &windowStart, 1, window, sizeof(window), NULL, NULL, I2C_IDLE, 0, 0};
+
+static uint8_t convCommand[2];
+static i2c_transaction_t convTransaction = {DS3231_ADDRESS, convCommand, sizeof(convCommand), NULL, 0, NULL, NULL, I2C_IDLE, 0, 0};
+
+static bool pending(const i2c_transaction_t *transaction)
+{
+    return (transaction->status == I2C_QUEUED) || (transaction->status == I2C_ACTIVE);
+}
+
+void temperature_init()
+{
+    temperature.valid = false;
+    temperature.converting = false;
+
+    /* Zero is always due, the first service reads the registers */
+    lastService = 0;
+    nextPoll = 0;
+}
+
+void temperature_request()
+{
+    if (pending(&convTransaction))
+    {
+        return;
+    }
+
+    /* CONV clears itself and stays out of the shadow, the other control bits come from the cache */
+    convCommand[0] = DS3231_CONTROL;
+    convCommand[1] = DS3231_cacheGet(DS3231_CONTROL) | DS3231_CONV;
+    if (i2c_enqueue(&convTransaction) == 0)
+    {
+        temperature.converting = true;
+        nextPoll = lastService + TEMPERATURE_POLL;
+    }
+}
+
+void temperature_service(const epoch_t now)
+{
+    lastService = now;
+
+    /* The clock was set back, do not wait out the difference */
+    if ((int32_t)(nextPoll - now) > (int32_t)DS3231_TEMP_PERIOD)
+    {
+        nextPoll = now;
+    }
+
+    if (pending(&readTransaction))
+    {
+        return;
+    }
+
+    if (readTransaction.status == I2C_DONE)
+    {
+        readTransaction.status = I2C_IDLE;
+
+        if ((window[0] & DS3231_CONV) || (window[1] & DS3231_BSY))
+        {
+            /* Conversion running, look again shortly */
+            temperature.converting = true;
+            nextPoll = now + TEMPERATURE_POLL;
+        }
+        else
+        {
+            temperature.value = DS3231_decodeTemp(window[DS3231_TEMP_MSB - DS3231_CONTROL], window[DS3231_TEMP_lSB - DS3231_CONTROL]);
+            temperature.timestamp = now;
+            temperature.valid = true;
+            temperature.converting = false;
+
+            /* Registers only change with the next automatic conversion */
+            nextPoll = now + DS3231_TEMP_PERIOD;
+        }
+    }
+    else if (readTransaction.status != I2C_IDLE)
+    {
+        readTransaction.status = I2C_IDLE;
+        nextPoll = now + TEMPERATURE_POLL;
+    }
+
+    if ((int32_t)(now - nextPoll) >= 0)
+    {
+        i2c_enqueue(&readTransaction);
+    }
+}
+
+const temperature_t *temperature_get()
+{
+    return &temperature;
+}
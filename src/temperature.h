@@ -0,0 +1,24 @@
+#ifndef TEMPERATURE_H_
+#define TEMPERATURE_H_
+
+#include "clock.h"
+#include "epoch.h"
+
+/* Seconds between BSY polls while a conversion is running */
+#define TEMPERATURE_POLL 1U
+
+typedef struct
+{
+  int16_t value;      /* Quarter degrees Celsius (Q8.2) */
+  epoch_t timestamp;  /* Software clock when the value was read */
+  bool valid;
+  bool converting;
+} temperature_t;
+
+void temperature_init( void );
+void temperature_request( void );
+void temperature_service( const epoch_t now );
+
+const temperature_t *temperature_get( void );
+
+#endif /* TEMPERATURE_H_ */
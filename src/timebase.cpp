@@ -0,0 +1,126 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "timebase.h"
+
+static volatile uint32_t secondsCounter = 0;
+static uint16_t ticksPerSecond = TIMEBASE_INTERPOLATE_HZ;
+static void (*secondHandler)(void) = NULL;
+
+void timebase_init(const DS3231_sqw_rate_t rate, void (*onSecond)(void))
+{
+    secondHandler = onSecond;
+
+    DS3231_setSquareWave(rate);
+
+    TCCR1A = 0x00;
+    TCNT1 = 0;
+
+    switch (rate)
+    {
+    case DS3231_SQW_1024HZ:
+        ticksPerSecond = 1024;
+        break;
+
+    case DS3231_SQW_4096HZ:
+        ticksPerSecond = 4096;
+        break;
+
+    case DS3231_SQW_8192HZ:
+        ticksPerSecond = 8192;
+        break;
+
+    default:
+        /* 1 Hz edges arrive on INT0, Timer1 interpolates and is restarted every second */
+        ticksPerSecond = TIMEBASE_INTERPOLATE_HZ;
+        TCCR1B = _BV(CS12);
+        TIMSK1 = 0x00;
+        return;
+    }
+
+    /* SQW counted on T1 (PD5), CTC divides it down to the 1 Hz heartbeat */
+    DDRD &= ~_BV(PORTD5);
+    OCR1A = ticksPerSecond - 1;
+    TCCR1B = _BV(WGM12) | _BV(CS12) | _BV(CS11) | _BV(CS10);
+    TIMSK1 = _BV(OCIE1A);
+}
+
+void timebase_secondEdge()
+{
+    TCNT1 = 0;
+    secondsCounter++;
+    if (secondHandler != NULL)
+    {
+        secondHandler();
+    }
+}
+
+uint16_t timebase_rate()
+{
+    return ticksPerSecond;
+}
+
+static void snapshot(uint32_t *seconds, uint16_t *ticks)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        *seconds = secondsCounter;
+        *ticks = TCNT1;
+
+        /* Compare match already wrapped TCNT1 but its ISR has not run yet */
+        if ((TIMSK1 & _BV(OCIE1A)) && (TIFR1 & _BV(OCF1A)) && (*ticks < (ticksPerSecond >> 1)))
+        {
+            (*seconds)++;
+        }
+    }
+
+    /* A slow RTC second must not run into the next one */
+    if (*ticks >= ticksPerSecond)
+    {
+        *ticks = ticksPerSecond - 1;
+    }
+}
+
+uint32_t timebase_ticks()
+{
+    uint32_t seconds;
+    uint16_t ticks;
+
+    snapshot(&seconds, &ticks);
+    return (seconds * ticksPerSecond) + ticks;
+}
+
+uint16_t timebase_ticks16()
+{
+    return (uint16_t)timebase_ticks();
+}
+
+uint32_t timebase_seconds()
+{
+    uint32_t seconds;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        seconds = secondsCounter;
+    }
+    return seconds;
+}
+
+uint32_t timebase_millis()
+{
+    uint32_t seconds;
+    uint16_t ticks;
+
+    snapshot(&seconds, &ticks);
+    return (seconds * 1000UL) + (((uint32_t)ticks * 1000UL) / ticksPerSecond);
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+    secondsCounter++;
+    if (secondHandler != NULL)
+    {
+        secondHandler();
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <stdint.h>
+
+#include "ds3231.h"
+
+/* Timer1 prescaler used to interpolate between 1 Hz edges, F_CPU/256 */
+#define TIMEBASE_INTERPOLATE_HZ (F_CPU / 256UL)
+
+#if TIMEBASE_INTERPOLATE_HZ > 65535UL
+#error "Timer1 would overflow within one second, change the prescaler"
+#endif
+
+void timebase_init( const DS3231_sqw_rate_t rate, void (*onSecond)( void ) );
+void timebase_secondEdge( void );
+
+uint16_t timebase_rate( void );
+uint16_t timebase_ticks16( void );
+uint32_t timebase_ticks( void );
+uint32_t timebase_seconds( void );
+uint32_t timebase_millis( void );
+
+#endif /* TIMEBASE_H_ */
@@ -0,0 +1,8 @@
+/* Host stand-in for <avr/interrupt.h>, interrupts are simulated by the tests */
+#ifndef SHIM_AVR_INTERRUPT_H_
+#define SHIM_AVR_INTERRUPT_H_
+
+#define sei()
+#define cli()
+
+#endif /* SHIM_AVR_INTERRUPT_H_ */
@@ -0,0 +1,10 @@
+/* Host stand-in for <avr/io.h>, the modules under test only need the bit helper and the ATmega328P RAM size */
+#ifndef SHIM_AVR_IO_H_
+#define SHIM_AVR_IO_H_
+
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+#define RAMEND 0x8FF
+
+#endif /* SHIM_AVR_IO_H_ */
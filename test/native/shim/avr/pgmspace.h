@@ -0,0 +1,15 @@
+/* Host stand-in for <avr/pgmspace.h>, flash and RAM share one address space */
+#ifndef SHIM_AVR_PGMSPACE_H_
+#define SHIM_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define strcpy_P strcpy
+
+#endif /* SHIM_AVR_PGMSPACE_H_ */
@@ -0,0 +1,8 @@
+/* Host stand-in for <util/atomic.h>, runs the block once without masking anything */
+#ifndef SHIM_UTIL_ATOMIC_H_
+#define SHIM_UTIL_ATOMIC_H_
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_BLOCK(type) for (uint8_t _once = 1; _once; _once = 0)
+
+#endif /* SHIM_UTIL_ATOMIC_H_ */
@@ -0,0 +1,8 @@
+/* Host stand-in for <util/delay.h> */
+#ifndef SHIM_UTIL_DELAY_H_
+#define SHIM_UTIL_DELAY_H_
+
+#define _delay_ms(ms)
+#define _delay_us(us)
+
+#endif /* SHIM_UTIL_DELAY_H_ */
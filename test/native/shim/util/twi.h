@@ -0,0 +1,8 @@
+/* Host stand-in for <util/twi.h>, only the constants i2c.h builds on */
+#ifndef SHIM_UTIL_TWI_H_
+#define SHIM_UTIL_TWI_H_
+
+#define TW_WRITE 0
+#define TW_READ 1
+
+#endif /* SHIM_UTIL_TWI_H_ */
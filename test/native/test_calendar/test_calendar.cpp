@@ -0,0 +1,139 @@
+#include <unity.h>
+
+#include "clock.h"
+#include "calendar.cpp"
+
+/* Days from 1970-01-01 in the proleptic Gregorian calendar (H. Hinnant, days_from_civil) */
+static int32_t daysFromCivil(int32_t year, const uint8_t month, const uint8_t day)
+{
+    year -= (month <= 2);
+    const int32_t era = ((year >= 0) ? year : (year - 399)) / 400;
+    const uint32_t yearOfEra = year - (era * 400);
+    const uint32_t dayOfYear = (((153 * (month + ((month > 2) ? -3 : 9))) + 2) / 5) + day - 1;
+    const uint32_t dayOfEra = (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear;
+    return (era * 146097) + (int32_t)dayOfEra - 719468;
+}
+
+/* 0 = Sunday, 1970-01-01 was a Thursday */
+static uint8_t referenceWeekday(const int32_t days)
+{
+    return ((days % DAYS_PER_WEEK) + DAYS_PER_WEEK + ISO_THURSDAY) % DAYS_PER_WEEK;
+}
+
+static bool referenceLeap(const uint16_t year)
+{
+    return (((year % 4) == 0) && ((year % 100) != 0)) || ((year % 400) == 0);
+}
+
+static uint8_t referenceMonthLength(const uint16_t year, const uint8_t month)
+{
+    return daysFromCivil(year + (month / MONTHS_PER_YEAR), (month % MONTHS_PER_YEAR) + 1, 1) - daysFromCivil(year, month, 1);
+}
+
+/* ISO 8601, the week belongs to the year its Thursday falls in */
+static uint8_t referenceIsoWeek(const uint16_t year, const uint8_t month, const uint8_t day)
+{
+    const int32_t days = daysFromCivil(year, month, day);
+    const uint8_t weekday = referenceWeekday(days);
+    const int32_t thursday = days + ISO_THURSDAY - ((weekday == 0) ? DAYS_PER_WEEK : weekday);
+
+    int32_t thursdayYear = year;
+    if (thursday < daysFromCivil(year, 1, 1))
+    {
+        thursdayYear--;
+    }
+    else if (thursday >= daysFromCivil(year + 1, 1, 1))
+    {
+        thursdayYear++;
+    }
+    return ((thursday - daysFromCivil(thursdayYear, 1, 1)) / DAYS_PER_WEEK) + 1;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_leap_years(void)
+{
+    for (uint16_t year = 1; year <= UPPER_TOP_YEARS; year++)
+    {
+        TEST_ASSERT_EQUAL_MESSAGE(referenceLeap(year), isLeapYear(year), "isLeapYear");
+    }
+}
+
+void test_month_lengths(void)
+{
+    for (uint16_t year = 1; year <= UPPER_TOP_YEARS; year++)
+    {
+        for (uint8_t month = 1; month <= MONTHS_PER_YEAR; month++)
+        {
+            TEST_ASSERT_EQUAL_UINT8(referenceMonthLength(year, month), month_length(year, month));
+        }
+    }
+}
+
+void test_weekday_of_january_first(void)
+{
+    for (uint16_t year = 1; year <= UPPER_TOP_YEARS; year++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(referenceWeekday(daysFromCivil(year, 1, 1)), calendar_jan1Weekday(year));
+    }
+}
+
+/* Every date in the supported range, checked against days-from-civil */
+void test_every_date(void)
+{
+    char message[32];
+
+    for (uint16_t year = 1; year <= UPPER_TOP_YEARS; year++)
+    {
+        const int32_t jan1 = daysFromCivil(year, 1, 1);
+        const bool leap = referenceLeap(year);
+
+        for (uint8_t month = 1; month <= MONTHS_PER_YEAR; month++)
+        {
+            for (uint8_t day = 1; day <= referenceMonthLength(year, month); day++)
+            {
+                const int32_t days = daysFromCivil(year, month, day);
+                snprintf(message, sizeof(message), "%04u-%02u-%02u", year, month, day);
+
+                const uint16_t dayOfYear = calendar_dayOfYear(year, month, day);
+                TEST_ASSERT_EQUAL_UINT16_MESSAGE(days - jan1 + 1, dayOfYear, message);
+                TEST_ASSERT_EQUAL_UINT8_MESSAGE(referenceWeekday(days), calendar_weekday(year, month, day), message);
+                TEST_ASSERT_EQUAL_UINT8_MESSAGE(referenceIsoWeek(year, month, day), calendar_isoWeek(year, month, day), message);
+
+                uint8_t monthBack;
+                uint8_t dayBack;
+                calendar_monthDay(dayOfYear, leap, &monthBack, &dayBack);
+                TEST_ASSERT_EQUAL_UINT8_MESSAGE(month, monthBack, message);
+                TEST_ASSERT_EQUAL_UINT8_MESSAGE(day, dayBack, message);
+            }
+        }
+    }
+}
+
+/* 16 bit day count, valid while it fits, which covers the epoch_t range */
+void test_days_before_year(void)
+{
+    const int32_t base = daysFromCivil(CALENDAR_BASE_YEAR, 1, 1);
+
+    for (uint16_t year = CALENDAR_BASE_YEAR; (daysFromCivil(year, 1, 1) - base) <= UINT16_MAX; year++)
+    {
+        TEST_ASSERT_EQUAL_UINT16(daysFromCivil(year, 1, 1) - base, calendar_daysBeforeYear(year));
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_leap_years);
+    RUN_TEST(test_month_lengths);
+    RUN_TEST(test_weekday_of_january_first);
+    RUN_TEST(test_every_date);
+    RUN_TEST(test_days_before_year);
+    return UNITY_END();
+}
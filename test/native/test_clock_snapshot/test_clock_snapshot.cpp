@@ -0,0 +1,133 @@
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+
+#include "clock.h"
+#include "calendar.cpp"
+#include "format.cpp"
+#include "clock.cpp"
+
+/* Output paths of clock.cpp, not exercised here */
+void uart0_puts(const char *) {}
+void uart0_putc(uint8_t) {}
+void display_update(display_field_t *, const char *) {}
+uint8_t DS3231_toBcd(uint8_t value) { return ((value / 10) << 4) | (value % 10); }
+void DS3231_setDateTime(const DS3231_buffer_t *) {}
+extern "C" uint8_t i2c_enqueue(i2c_transaction_t *) { return 0; }
+void alarm_reload(void) {}
+
+#define SNAPSHOT_READS 2000000UL
+
+/*
+ * The tick ISR is simulated by a thread that ticks the clock as fast as it
+ * can, the main thread takes snapshots meanwhile. The seqlock only relies
+ * on compiler barriers, which is what the AVR needs and what a host with a
+ * strongly ordered memory model (x86) gives as well.
+ */
+static clock_control_t clockControl;
+static std::atomic<bool> stopTicking(false);
+static std::atomic<uint32_t> ticks(0);
+
+static void tickInterrupt()
+{
+    while (!stopTicking.load(std::memory_order_relaxed))
+    {
+        clock_tick(&clockControl);
+        ticks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/* Fields the tick writes one after the other, a torn copy mixes two seconds */
+static bool consistent(const clock_control_t *snapshot)
+{
+    clock_control_t expected = *snapshot;
+    clock_deriveFields(&expected);
+    clock_refreshStrings(&expected);
+
+    return (snapshot->time.seconds < SECONDS_PER_MINUTE) && (snapshot->time.minutes < MINUTES_PER_HOUR) &&
+           (snapshot->time.hours < HOURS_PER_DAY) && (snapshot->weekday == expected.weekday) &&
+           (snapshot->dayOfYear == expected.dayOfYear) && (snapshot->daysInCurrentMonth == expected.daysInCurrentMonth) &&
+           (strcmp(snapshot->timeString, expected.timeString) == 0) && (strcmp(snapshot->dateString, expected.dateString) == 0);
+}
+
+static uint64_t sortKey(const clock_control_t *snapshot)
+{
+    uint64_t key = snapshot->date.years.yyyy;
+    key = (key * 100) + snapshot->date.months;
+    key = (key * 100) + snapshot->date.days;
+    key = (key * 100) + snapshot->time.hours;
+    key = (key * 100) + snapshot->time.minutes;
+    return (key * 100) + snapshot->time.seconds;
+}
+
+void setUp(void)
+{
+    /* One minute before a year change, the carry chain runs through every field early on */
+    memset(&clockControl, 0, sizeof(clockControl));
+    clockControl.date.years.yyyy = 2023;
+    clockControl.date.months = 12;
+    clockControl.date.days = 31;
+    clockControl.time.hours = 23;
+    clockControl.time.minutes = 59;
+    clockControl.time.seconds = 0;
+    clockControl.clockState = RUNNING;
+    clock_deriveFields(&clockControl);
+    clock_refreshBCD(&clockControl);
+    clock_refreshStrings(&clockControl);
+
+    stopTicking = false;
+    ticks = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_snapshot_without_ticks(void)
+{
+    clock_control_t snapshot;
+
+    clock_snapshot(&clockControl, &snapshot);
+    TEST_ASSERT_TRUE(memcmp(&snapshot, &clockControl, sizeof(snapshot)) == 0);
+}
+
+void test_snapshot_never_torn(void)
+{
+    uint32_t torn = 0;
+    uint32_t regressions = 0;
+    uint64_t lastKey = 0;
+
+    std::thread isr(tickInterrupt);
+    for (uint32_t read = 0; read < SNAPSHOT_READS; read++)
+    {
+        clock_control_t snapshot;
+        clock_snapshot(&clockControl, &snapshot);
+
+        if (!consistent(&snapshot))
+        {
+            torn++;
+        }
+
+        uint64_t key = sortKey(&snapshot);
+        if (key < lastKey)
+        {
+            regressions++;
+        }
+        lastKey = key;
+    }
+    stopTicking = true;
+    isr.join();
+
+    TEST_ASSERT_TRUE_MESSAGE(ticks > 0, "the simulated ISR never ran during the reads");
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, regressions);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_snapshot_without_ticks);
+    RUN_TEST(test_snapshot_never_torn);
+    return UNITY_END();
+}